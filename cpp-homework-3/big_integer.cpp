@@ -1,12 +1,22 @@
 /* Nikolai Kholiavin, M3138 */
 
+#include <cassert>
 #include <cstring>
 #include <stdexcept>
 #include <algorithm>
 #include <iostream>
 #include <sstream>
+#include <memory>
+#include <mutex>
+#include <map>
+#include <deque>
+#include <cmath>
 
 #include "big_integer.h"
+#include "place_arithmetic.h"
+#include "thread_pool.h"
+
+using namespace big_int_util;
 
 /* Basis for big integer functions */
 template<typename type>
@@ -83,6 +93,28 @@ bool big_integer::make_absolute()
   return sign;
 }
 
+big_integer::magnitude big_integer::get_magnitude() const
+{
+  magnitude res;
+  if (sign_bit())
+  {
+    res.storage.assign(data.begin(), data.end());
+    negate_n(res.storage.data(), res.storage.size());
+    res.places = res.storage.data();
+  }
+  else
+    res.places = data.data();
+  res.size = normalized_size(res.places, data.size());
+  return res;
+}
+
+big_integer & big_integer::set_magnitude_sign(bool sign)
+{
+  if (sign)
+    negate_n(data.data(), data.size());
+  return shrink();
+}
+
 void big_integer::iterate(const big_integer &b, const binary_operator &action)
 {
   resize(std::max(data.size(), b.data.size()));
@@ -143,26 +175,8 @@ big_integer::big_integer(place_t place) : data(1, place)
   correct_sign_bit(0);
 }
 
-big_integer::big_integer(const std::string &str) : data(1, place_t{0})
+big_integer::big_integer(std::string_view str, int base) : big_integer(str.data(), str.data() + str.size(), base)
 {
-  auto it = str.cbegin();
-  bool is_negated = false;
-  if (it != str.cend() && *it == '-')
-  {
-    is_negated = true;
-    it++;
-  }
-
-  if (it == str.cend())
-    throw std::runtime_error("Cannot read number from string: '" + str + "'");
-
-  for (; it != str.cend(); it++)
-  {
-    short_multiply(10);
-    *this += *it - '0';
-  }
-
-  revert_sign(is_negated);
 }
 
 big_integer::~big_integer()
@@ -192,8 +206,6 @@ template<typename type>
 
 static inline uint32_t low_bytes(uint64_t x) { return x & 0xFFFFFFFF; }
 static inline uint32_t high_bytes(uint64_t x) { return x >> 32; }
-static inline uint16_t low_bytes(uint32_t x) { return x & 0xFFFF; }
-static inline uint16_t high_bytes(uint32_t x) { return x >> 16; }
 
 static std::pair<uint64_t, uint64_t> mul(uint64_t left, uint64_t right)
 {
@@ -216,366 +228,2205 @@ static std::pair<uint64_t, uint64_t> mul(uint64_t left, uint64_t right)
   };
 }
 
-static std::pair<uint32_t, uint32_t> mul(uint32_t left, uint32_t right)
+// left shift which normalizes nonzero x (sets its highest bit), 32 for zero
+static unsigned normalization_shift(uint32_t x)
+{
+  unsigned shift = 0;
+  while (shift < std::numeric_limits<uint32_t>::digits &&
+         (x << shift) >> (std::numeric_limits<uint32_t>::digits - 1) == 0)
+    shift++;
+  return shift;
+}
+
+// throws std::domain_error for zero divisor
+static void check_divisor(const big_integer &divisor)
 {
-  uint64_t res = uint64_t{left} * right;
-  return {low_bytes(res), high_bytes(res)};
+  if (divisor == 0)
+    throw std::domain_error("Division by zero");
 }
 
-static bool less_3_digits(uint64_t lhs_low, uint32_t lhs_high,
-                          uint64_t rhs_low, uint32_t rhs_high)
+/* Division by invariant integers with multiplications by reciprocal
+ * (Moller & Granlund, "Improved division by invariant integers"),
+ * reciprocals are computed once for many divisions by the same normalized divisor */
+
+// reciprocal floor((B^2 - 1) / d) - B of normalized d (highest bit is set)
+static uint32_t reciprocal_2_1(uint32_t rhs)
 {
-  return lhs_high < rhs_high || (lhs_high == rhs_high && lhs_low < rhs_low);
+  return static_cast<uint32_t>(~(uint64_t{rhs} << 32) / rhs);
 }
 
-static uint64_t get_3_digits(uint64_t low, uint32_t high, int at)
+// quotient & remainder of (lhs_high, lhs_low) / rhs with reciprocal inv, lhs_high < rhs (algorithm 4)
+static std::pair<uint32_t, uint32_t> div2_1(uint32_t lhs_low, uint32_t lhs_high, uint32_t rhs, uint32_t inv)
 {
-  switch (at)
+  uint64_t q = uint64_t{inv} * lhs_high + ((uint64_t{lhs_high} << 32) | lhs_low);
+  uint32_t q1 = high_bytes(q) + 1, q0 = low_bytes(q);
+  uint32_t r = lhs_low - q1 * rhs;
+  // unpredictable condition, without branch
+  uint32_t mask = 0 - static_cast<uint32_t>(r > q0);
+  q1 += mask;
+  r += mask & rhs;
+  if (r >= rhs)
   {
-  case -1:
-    return high;
-  case 0:
-    return (uint64_t{high} << 16) | (low >> 48);
-  case 1:
-    return (uint64_t{low_bytes(high)} << 32) | (low >> 32);
+    q1++;
+    r -= rhs;
   }
-  return 0;
+  return {q1, r};
 }
 
-static std::pair<uint64_t, uint32_t> sub_5_digits(uint64_t lhs_low, uint32_t lhs_high,
-                                                  uint64_t rhs_low, uint16_t rhs_high, int at)
+// reciprocal floor((B^3 - 1) / d) - B of normalized d = rhs_high * B + rhs_low (algorithm 6)
+static uint32_t reciprocal_3_2(uint32_t rhs_low, uint32_t rhs_high)
 {
-  if (at == 0)
+  uint32_t v = reciprocal_2_1(rhs_high);
+  uint32_t p = rhs_high * v + rhs_low;
+  if (p < rhs_low)
   {
-    uint64_t l64 = (uint64_t{low_bytes(lhs_high)} << 48)| (lhs_low >> 16);
-    bool borrow = 0;
-    l64 = addc(l64, ~rhs_low + 1, borrow);
-    uint16_t l16 = high_bytes(lhs_high);
-    l16 -= borrow;
-    borrow = 0;
-    l16 = addc(l16, (uint16_t)(~rhs_high + 1), borrow);
-    lhs_high = (uint32_t{l16} << 16) | (uint32_t)(l64 >> 48);
-    lhs_low = (l64 << 16) | low_bytes(lhs_low);
+    v--;
+    if (p >= rhs_high)
+    {
+      v--;
+      p -= rhs_high;
+    }
+    p -= rhs_high;
   }
-  else
+  uint64_t t = uint64_t{v} * rhs_low;
+  p += high_bytes(t);
+  if (p < high_bytes(t))
   {
-    bool borrow = 0;
-    lhs_low = addc(lhs_low, ~rhs_low + 1, borrow);
-    lhs_high -= borrow;
-    borrow = 0;
-    lhs_high = addc(lhs_high, (uint32_t)(~rhs_high + 1), borrow);
+    v--;
+    if (((uint64_t{p} << 32) | low_bytes(t)) >= ((uint64_t{rhs_high} << 32) | rhs_low))
+      v--;
   }
-  return {lhs_low, lhs_high};
+  return v;
 }
 
+// quotient & remainder of (lhs_high, lhs_med, lhs_low) / (rhs_high, rhs_low) with reciprocal inv,
+// (lhs_high, lhs_med) < (rhs_high, rhs_low) (algorithm 5)
 static std::pair<uint32_t, uint64_t> div3_2(uint32_t lhs_low, uint32_t lhs_med, uint32_t lhs_high,
-                                            uint32_t rhs_low, uint32_t rhs_high)
-{
-  // divide in base 2^16 with trial digits on prefixes
-  uint64_t
-    r_low64 = (uint64_t{lhs_med} << 32) | lhs_low,
-    d = (uint64_t{rhs_high} << 32) | rhs_low;
-  uint32_t
-    r_high = lhs_high,
-    d2 = rhs_high;
-
-  if (get_3_digits(r_low64, r_high, -1) / d2 != 0)
-    // overflow
-    return {std::numeric_limits<uint32_t>::max(), 0};
-
-  // high trial digit
-  uint16_t qt1 = (uint16_t)(get_3_digits(r_low64, r_high, 0) / d2);
-  auto dq = mul(d, uint64_t{qt1});
-  if (less_3_digits(r_low64, r_high, dq.first << 16, low_bytes((dq.second << 16) | (dq.first >> 48))))
+                                            uint32_t rhs_low, uint32_t rhs_high, uint32_t inv)
+{
+  uint64_t d = (uint64_t{rhs_high} << 32) | rhs_low;
+  uint64_t q = uint64_t{inv} * lhs_high + ((uint64_t{lhs_high} << 32) | lhs_med);
+  uint32_t q1 = high_bytes(q), q0 = low_bytes(q);
+  uint32_t r1 = lhs_med - q1 * rhs_high;
+  uint64_t r = ((uint64_t{r1} << 32) | lhs_low) - uint64_t{rhs_low} * q1 - d;
+  q1++;
+  if (high_bytes(r) >= q0)
   {
-    // correct estimate
-    qt1--;
-    dq = mul(d, uint64_t{qt1});
+    q1--;
+    r += d;
   }
-  // subtract from remainder
-  auto rmdq = sub_5_digits(r_low64, r_high, dq.first, (uint16_t)dq.second, 0);
-  r_low64 = rmdq.first;
-  r_high = rmdq.second;
-
-  // low trial digit
-  uint16_t qt2 = (uint16_t)(get_3_digits(r_low64, r_high, 1) / d2);
-  dq = mul(d, uint64_t{qt2});
-  if (less_3_digits(r_low64, r_high, dq.first, low_bytes(dq.second)))
+  if (r >= d)
   {
-    // correct estimate
-    qt2--;
-    dq = mul(d, uint64_t{qt2});
+    q1++;
+    r -= d;
   }
-  // subtract from remainder
-  rmdq = sub_5_digits(r_low64, r_high, dq.first, (uint16_t)dq.second, 1);
-  r_low64 = rmdq.first;
-  r_high = rmdq.second;
-
-  return {(uint32_t{qt1} << 16) | qt2, r_low64};
+  return {q1, r};
 }
 
-static std::pair<uint32_t, uint32_t> div2_1(uint32_t lhs_low, uint32_t lhs_high, uint32_t rhs)
+// q[0, n) = a[0, n) / (d >> shift), returns remainder (may be done in place),
+// d is normalized with shift, inv is its reciprocal_2_1,
+// dividend is shifted by places on the fly
+static uint32_t divrem_1(uint32_t *q, const uint32_t *a, size_t n, uint32_t d, unsigned shift, uint32_t inv)
 {
-  uint64_t lhs = ((uint64_t{lhs_high} << 32) | lhs_low);
-  return {(uint32_t)(lhs / rhs), (uint32_t)(lhs % rhs)};
+  if (n == 0)
+    return 0;
+  uint32_t r = 0;
+  if (shift == 0)
+    for (size_t i = n; i-- > 0;)
+    {
+      auto qr = div2_1(a[i], r, d, inv);
+      q[i] = qr.first;
+      r = qr.second;
+    }
+  else
+  {
+    r = a[n - 1] >> (std::numeric_limits<uint32_t>::digits - shift);
+    for (size_t i = n; i-- > 0;)
+    {
+      uint32_t place = a[i] << shift;
+      if (i > 0)
+        place |= a[i - 1] >> (std::numeric_limits<uint32_t>::digits - shift);
+      auto qr = div2_1(place, r, d, inv);
+      q[i] = qr.first;
+      r = qr.second;
+    }
+  }
+  return r >> shift;
 }
 
 /***
- * Rest of arithmetic operators for big_integer
+ * Arithmetic functions for place arrays (little-endian magnitudes)
  ***/
 
-big_integer & big_integer::operator+=(const big_integer &rhs)
-{
-  bool old_sign = sign_bit(), rhs_sign = rhs.sign_bit();
-  bool carry = 0;
-  iterate(rhs, [&](place_t l, place_t r) { return addc(l, r, carry); });
-  if (old_sign == rhs_sign)
-    correct_sign_bit(old_sign);
-
-  // 1... + 1... => 0... + carry  | new place
-  //                1... + carry  |
-  // 0... + 0... => 1... no carry | new place
-  //                0... no carry |
-  // 1... + 0... => 1... no carry |
-  //                0... + carry  |
+// basecase with 64-bit words is about 4 times faster
+size_t big_integer::tuning::karatsuba_threshold = wide_basecase() ? 64 : 32;
+size_t big_integer::tuning::sqr_karatsuba_threshold = wide_basecase() ? 96 : 48;
+size_t big_integer::tuning::toom3_threshold = 200;
+size_t big_integer::tuning::toom4_threshold = 600;
+size_t big_integer::tuning::ntt_threshold = 12000;
+size_t big_integer::tuning::burnikel_ziegler_threshold = 24;
+size_t big_integer::tuning::newton_division_threshold = 120000;
+size_t big_integer::tuning::conversion_threshold = 60;
+big_integer::tuning::mode big_integer::tuning::ntt = big_integer::tuning::mode::automatic;
+big_integer::tuning::mode big_integer::tuning::parallel = big_integer::tuning::mode::automatic;
+size_t big_integer::tuning::parallel_threshold = 100000;
+size_t big_integer::tuning::threads = 0;
+
+// inverse of odd x modulo 2^32 by Newton iteration (each one doubles correct bits)
+static uint32_t inverse_mod_base(uint32_t x)
+{
+  uint32_t inv = x; // x * x = 1 (mod 8)
+  for (int i = 0; i < 4; i++)
+    inv *= 2 - x * inv;
+  return inv;
+}
+
+// in place exact division of places[0, n) by d (remainder must be zero)
+// with multiplication by inverse modulo base instead of division
+static void divexact_1(uint32_t *places, size_t n, uint32_t d)
+{
+  int shift = 0;
+  while ((d & 1) == 0)
+  {
+    d >>= 1;
+    shift++;
+  }
+  if (shift != 0)
+    for (size_t i = 0; i < n; i++)
+      places[i] = (places[i] >> shift) |
+        (i + 1 < n ? places[i + 1] << (std::numeric_limits<uint32_t>::digits - shift) : 0);
 
-  return shrink();
+  uint32_t inv = inverse_mod_base(d), borrow = 0;
+  for (size_t i = 0; i < n; i++)
+  {
+    uint32_t place = places[i], q = (place - borrow) * inv;
+    places[i] = q;
+    borrow = high_bytes(uint64_t{q} * d) + (place < borrow);
+  }
 }
 
-big_integer & big_integer::operator-=(const big_integer &rhs)
-{
-  return *this += -rhs;
-}
+static void mul_places(uint32_t *res, const uint32_t *a, size_t an, const uint32_t *b, size_t bn);
+static void sqr_places(uint32_t *res, const uint32_t *a, size_t n);
 
-// multiplication by a positive integer that fits into place_t
-big_integer & big_integer::short_multiply(place_t rhs)
+// Karatsuba multiplication, an, bn > ceil(max(an, bn) / 2),
+// b0 + b1 may be given in b_sum[0, b_sum_n) if it is precomputed
+static void mul_karatsuba(uint32_t *res, const uint32_t *a, size_t an, const uint32_t *b, size_t bn,
+                          const uint32_t *b_sum = nullptr, size_t b_sum_n = 0)
 {
-  bool old_sign = make_absolute();
+  // a = a1 * B^h + a0, b = b1 * B^h + b0
+  size_t h = (std::max(an, bn) + 1) / 2, a1n = an - h, b1n = bn - h;
+  const uint32_t *a0 = a, *a1 = a + h, *b0 = b, *b1 = b + h;
 
-  place_t carry = 0;
-  iterate([&](place_t datai)
-    {
-      auto res_carry = mul(datai, rhs);
-      bool add_carry = false;
-      place_t result = addc(res_carry.first, carry, add_carry);
-      carry = addc(res_carry.second, place_t{ 0 }, add_carry);
-      return result;
-    });
-  correct_sign_bit(0, carry);
-  return revert_sign(old_sign);
-}
+  // a0 * b0 -> res[0, 2h), a1 * b1 -> res[2h, an + bn)
+  mul_places(res, a0, h, b0, h);
+  mul_places(res + 2 * h, a1, a1n, b1, b1n);
 
-big_integer & big_integer::operator*=(const big_integer &rhs)
-{
-  bool sign = make_absolute() ^ rhs.sign_bit();
-  big_integer right = rhs.sign_bit() ? -rhs : rhs;
+  // middle term (a0 + a1) * (b0 + b1) - a0 * b0 - a1 * b1
+  std::vector<uint32_t> sa(h + 1), sb(b_sum == nullptr ? h + 1 : 0), mid(2 * h + 2);
+  sa[h] = add(sa.data(), a0, h, a1, a1n);
+  if (b_sum == nullptr)
+  {
+    sb[h] = add(sb.data(), b0, h, b1, b1n);
+    b_sum = sb.data();
+    b_sum_n = h + 1;
+  }
+  mul_places(mid.data(), sa.data(), h + 1, b_sum, b_sum_n);
+  sub(mid.data(), mid.data(), mid.size(), res, 2 * h);
+  sub(mid.data(), mid.data(), mid.size(), res + 2 * h, a1n + b1n);
 
-  big_integer res = 0;
-  int i = 0;
-  right.iterate([&](place_t rdatai)
-    {
-      res += big_integer(*this).short_multiply(rdatai) << ((int)i * PLACE_BITS);
-      i++;
-    });
-  return *this = res.revert_sign(sign);
+  size_t mid_size = normalized_size(mid.data(), mid.size());
+  add(res + h, res + h, an + bn - h, mid.data(), mid_size);
 }
 
-// division by a positive integer that fits into place_t,
-// (requires place_t to be uint32_t because of div2_1)
-big_integer & big_integer::short_divide(place_t rhs, place_t &rem)
+// Karatsuba squaring with subtractive middle term: a0^2 + a1^2 - (a0 - a1)^2, n >= 2
+static void sqr_karatsuba(uint32_t *res, const uint32_t *a, size_t n)
 {
-  rem = 0;
-  iterate_r([&](place_t datai)
-    {
-      auto res_rem = div2_1(datai, rem, rhs);
-      rem = res_rem.second;
-      return res_rem.first;
-    });
-  return shrink();
+  // a = a1 * B^h + a0
+  size_t h = (n + 1) / 2, a1n = n - h;
+  const uint32_t *a0 = a, *a1 = a + h;
+
+  // a0^2 -> res[0, 2h), a1^2 -> res[2h, 2n)
+  sqr_places(res, a0, h);
+  sqr_places(res + 2 * h, a1, a1n);
+
+  // |a0 - a1| fits in h places (a1 > a0 means a0 < B^a1n)
+  std::vector<uint32_t> diff(h), diff_sqr(2 * h), mid(2 * h + 1);
+  if (compare_places(a0, normalized_size(a0, h), a1, normalized_size(a1, a1n)) >= 0)
+    sub(diff.data(), a0, h, a1, a1n);
+  else
+    sub(diff.data(), a1, a1n, a0, a1n);
+  sqr_places(diff_sqr.data(), diff.data(), h);
+
+  mid[2 * h] = add(mid.data(), res, 2 * h, res + 2 * h, 2 * a1n);
+  sub(mid.data(), mid.data(), mid.size(), diff_sqr.data(), 2 * h);
+
+  size_t mid_size = normalized_size(mid.data(), mid.size());
+  add(res + h, res + h, 2 * n - h, mid.data(), mid_size);
 }
 
-// long division using algorithm with trial digits and division of prefixes
-// (requires place_t to be uint32_t because of short_divide, div2_1 & div3_2)
-big_integer & big_integer::long_divide(const big_integer &rhs, big_integer &rem)
+// signed number as magnitude & sign (evaluation & interpolation values of Toom-Cook)
+struct signed_places
 {
-  bool this_sign = make_absolute(), sign = this_sign ^ rhs.sign_bit();
+  std::vector<uint32_t> places;
+  bool negative = false;
 
-  big_integer right = rhs.sign_bit() ? -rhs : rhs;
+  signed_places() = default;
+  signed_places(const uint32_t *a, size_t n) : places(a, a + normalized_size(a, n))
+  {}
 
-  size_t n = unsigned_size(), m = right.unsigned_size();
+  signed_places & operator+=(const signed_places &rhs)
+  {
+    return add_signed(rhs, rhs.negative);
+  }
 
-  if (m == 1)
+  signed_places & operator-=(const signed_places &rhs)
   {
-    place_t r;
-    short_divide(right.data[0], r);
-    rem = big_integer(r);
+    return add_signed(rhs, !rhs.negative);
   }
-  else if (m > n)
+
+  signed_places & operator*=(uint32_t rhs)
   {
-    // divisor is greater than dividend, quotient is 0, remainder is dividend
-    rem = *this;
-    *this = 0;
+    uint64_t carry = 0;
+    for (uint32_t &place : places)
+    {
+      carry += uint64_t{place} * rhs;
+      place = low_bytes(carry);
+      carry = high_bytes(carry);
+    }
+    if (carry != 0)
+      places.push_back(static_cast<uint32_t>(carry));
+    return normalize();
   }
-  else
+
+  // exact division (remainder must be zero)
+  signed_places & divexact(uint32_t rhs)
   {
-    // divide with base 2^PLACE_BITS
-    // 2 <= m <= n -- true
+    divexact_1(places.data(), places.size(), rhs);
+    return normalize();
+  }
 
-    // copy operands: starting remainder is this, divisor is right
-    rem = *this;
-    big_integer d = right;
-
-    // normalize divisor d (largest place >= base / 2)
-    place_t f = d.data[m - 1] == std::numeric_limits<place_t>::max() ?
-      1 : div2_1(0, 1, d.data[m - 1] + 1).first;
-    rem.short_multiply(f);
-    d.short_multiply(f);
-
-    // 2 leading digits of divisor for quotient digits estimate
-    place_t d2_high = d.data[m - 1];
-    place_t d2_low = d.data[m - 2];
-    // compute quotient digits
-    std::vector<place_t> new_data(n - m + 1);
-    for (size_t ki = 0; ki <= n - m; ki++)
-    {
-      int k = (int)(n - m - ki);
-      // first, count 3 leading digits of remainder
-      place_t r3_high = k + m >= rem.data.size() ? 0 : rem.data[k + m];
-      place_t r3_med = k + m - 1 >= rem.data.size() ? 0 : rem.data[k + m - 1];
-      place_t r3_low = k + m - 2 >= rem.data.size() ? 0 : rem.data[k + m - 2];
-        // obtain k-th digit estimate
-      place_t qt = div3_2(r3_low, r3_med, r3_high, d2_low, d2_high).first;
-      // count result with estimate
-      big_integer dq = big_integer(d).short_multiply(qt) <<= k * PLACE_BITS;
-      if (rem < dq)
-      {
-        // wrong, correct estimate
-        qt--;
-        dq = big_integer(d).short_multiply(qt) <<= k * PLACE_BITS;
-      }
-      // set digit in quotient
-      new_data[k] = qt;
-      // subtract current result from remainder
-      rem -= dq;
+  // adds rhs magnitude with given sign
+  signed_places & add_signed(const signed_places &rhs, bool rhs_negative)
+  {
+    size_t n = places.size(), rn = rhs.places.size();
+    if (negative == rhs_negative)
+    {
+      places.resize(std::max(n, rn) + 1);
+      add(places.data(), places.data(), places.size(), rhs.places.data(), rn);
+    }
+    else if (compare_places(places.data(), n, rhs.places.data(), rn) >= 0)
+      sub(places.data(), places.data(), n, rhs.places.data(), rn);
+    else
+    {
+      places.resize(rn);
+      sub(places.data(), rhs.places.data(), rn, places.data(), n);
+      negative = rhs_negative;
     }
-    place_t dummy;
-    rem.short_divide(f, dummy);
-    data = storage_t(new_data);
-    correct_sign_bit(0);
+    return normalize();
   }
-  rem.revert_sign(this_sign);
-  return revert_sign(sign);
-}
 
-big_integer & big_integer::operator/=(const big_integer &rhs)
-{
-  big_integer dummy;
-  return long_divide(rhs, dummy);
-}
+  signed_places & normalize()
+  {
+    places.resize(normalized_size(places.data(), places.size()));
+    if (places.empty())
+      negative = false;
+    return *this;
+  }
+};
 
-big_integer & big_integer::operator%=(const big_integer &rhs)
+static signed_places operator*(const signed_places &a, const signed_places &b)
 {
-  big_integer(*this).long_divide(rhs, *this);
-  return *this;
+  signed_places res;
+  res.places.resize(a.places.size() + b.places.size());
+  mul_places(res.places.data(), a.places.data(), a.places.size(),
+             b.places.data(), b.places.size());
+  res.negative = a.negative ^ b.negative;
+  return res.normalize();
 }
 
-big_integer & big_integer::operator&=(const big_integer &rhs)
+static signed_places operator*(signed_places a, uint32_t b)
 {
-  return place_wise(rhs, std::bit_and<place_t>());
+  return a *= b;
 }
 
-big_integer & big_integer::operator|=(const big_integer &rhs)
-{
-  return place_wise(rhs, std::bit_or<place_t>());
+static signed_places sqr(const signed_places &a)
+{
+  signed_places res;
+  res.places.resize(2 * a.places.size());
+  sqr_places(res.places.data(), a.places.data(), a.places.size());
+  return res.normalize();
+}
+
+// res[at, size) += x, x must be non-negative
+static void add_at(uint32_t *res, size_t size, const signed_places &x, size_t at)
+{
+  assert(!x.negative);
+  add(res + at, res + at, size - at, x.places.data(), x.places.size());
+}
+
+// values of a[0, an) split into parts of k places (an > 2 * k) as polynomial of B^k
+// at points of Toom-3: 0, 1, -1, -2, infinity
+static std::vector<signed_places> evaluate_toom3(const uint32_t *a, size_t an, size_t k)
+{
+  signed_places p0(a, k), p1(a + k, k), p2(a + 2 * k, an - 2 * k);
+  std::vector<signed_places> at(5);
+  signed_places even = p0;
+  even += p2;
+  at[1] = even;
+  at[1] += p1;
+  at[2] = even;
+  at[2] -= p1;
+  at[3] = at[2];
+  at[3] += p2;
+  at[3] *= 2;
+  at[3] -= p0;
+  at[0] = std::move(p0);
+  at[4] = std::move(p2);
+  return at;
+}
+
+// res[0, n) = product from its values r at points of Toom-3 (interpolation with Bodrato's sequence)
+static void interpolate_toom3(uint32_t *res, size_t n, size_t k, std::vector<signed_places> &r)
+{
+  signed_places &r0 = r[0], &r1 = r[1], &r_m1 = r[2], &r_m2 = r[3], &r_inf = r[4];
+  signed_places r3 = r_m2;
+  r3 -= r1;
+  r3.divexact(3);
+  r1 -= r_m1;
+  r1.divexact(2);
+  signed_places r2 = r_m1;
+  r2 -= r0;
+  signed_places t = r2;
+  t -= r3;
+  t.divexact(2);
+  r3 = r_inf * 2;
+  r3 += t;
+  r2 += r1;
+  r2 -= r_inf;
+  r1 -= r3;
+
+  // recompose
+  std::fill_n(res, n, 0);
+  std::copy(r0.places.begin(), r0.places.end(), res);
+  std::copy(r_inf.places.begin(), r_inf.places.end(), res + 4 * k);
+  add_at(res, n, r1, k);
+  add_at(res, n, r2, 2 * k);
+  add_at(res, n, r3, 3 * k);
+}
+
+// products of values at the same points (squares if operands are the same)
+static std::vector<signed_places> pointwise_products(const std::vector<signed_places> &a,
+                                                     const std::vector<signed_places> &b, bool square)
+{
+  std::vector<signed_places> r(a.size());
+  for (size_t i = 0; i < a.size(); i++)
+    r[i] = square ? sqr(a[i]) : a[i] * b[i];
+  return r;
 }
 
-big_integer & big_integer::operator^=(const big_integer &rhs)
-{
-  return place_wise(rhs, std::bit_xor<place_t>());
-}
+// Toom-3 multiplication, an >= bn > 2 * ceil(an / 3)
+static void mul_toom3(uint32_t *res, const uint32_t *a, size_t an, const uint32_t *b, size_t bn)
+{
+  // a = a2 * x^2 + a1 * x + a0, b = b2 * x^2 + b1 * x + b0, x = B^k
+  bool square = a == b && an == bn;
+  size_t k = (an + 2) / 3;
+  std::vector<signed_places> a_at = evaluate_toom3(a, an, k), b_at;
+  if (!square)
+    b_at = evaluate_toom3(b, bn, k);
+
+  std::vector<signed_places> r = pointwise_products(a_at, b_at, square);
+  interpolate_toom3(res, an + bn, k, r);
+}
+
+// values of a[0, an) split into parts of k places (an > 3 * k) as polynomial of B^k
+// at points of Toom-4: 0, 1, -1, 2, -2, 3, infinity
+static std::vector<signed_places> evaluate_toom4(const uint32_t *a, size_t an, size_t k)
+{
+  signed_places p0(a, k), p1(a + k, k), p2(a + 2 * k, k), p3(a + 3 * k, an - 3 * k);
+  std::vector<signed_places> at(7);
+  signed_places even = p0, odd = p1;
+  even += p2;
+  odd += p3;
+  at[1] = even;
+  at[1] += odd;
+  at[2] = even;
+  at[2] -= odd;
+
+  even = p0;
+  even += p2 * 4;
+  odd = p1;
+  odd += p3 * 4;
+  odd *= 2;
+  at[3] = even;
+  at[3] += odd;
+  at[4] = even;
+  at[4] -= odd;
+
+  at[5] = p3 * 3;
+  at[5] += p2;
+  at[5] *= 3;
+  at[5] += p1;
+  at[5] *= 3;
+  at[5] += p0;
+  at[0] = std::move(p0);
+  at[6] = std::move(p3);
+  return at;
+}
+
+// res[0, n) = product from its values r at points of Toom-4,
+// c(x) = c6 * x^6 + ... + c0 is product as polynomial of x = B^k
+static void interpolate_toom4(uint32_t *res, size_t n, size_t k, std::vector<signed_places> &r)
+{
+  const signed_places &c0 = r[0], &c6 = r[6];
+  const signed_places &r1 = r[1], &r_m1 = r[2], &r2 = r[3], &r_m2 = r[4], &r3 = r[5];
+
+  // interpolate:
+  //   s1 = (c(1) + c(-1)) / 2 - c0 - c6 = c2 + c4
+  //   d1 = (c(1) - c(-1)) / 2 = c1 + c3 + c5
+  //   s2 = (c(2) + c(-2)) / 2 - c0 - 64 * c6 = 4 * c2 + 16 * c4
+  //   d2 = (c(2) - c(-2)) / 4 = c1 + 4 * c3 + 16 * c5
+  signed_places s1 = r1, d1 = r1, s2 = r2, d2 = r2;
+  s1 += r_m1;
+  s1.divexact(2);
+  s1 -= c0;
+  s1 -= c6;
+  d1 -= r_m1;
+  d1.divexact(2);
+  s2 += r_m2;
+  s2.divexact(2);
+  s2 -= c0;
+  s2 -= c6 * 64;
+  d2 -= r_m2;
+  d2.divexact(4);
+
+  //   c4 = (s2 - 4 * s1) / 12, c2 = s1 - c4
+  signed_places c4 = s2, c2 = s1;
+  c4 -= s1 * 4;
+  c4.divexact(12);
+  c2 -= c4;
+
+  //   e3 = (c(3) - c0 - 9 * c2 - 81 * c4 - 729 * c6) / 3 = c1 + 9 * c3 + 81 * c5
+  signed_places e3 = r3;
+  e3 -= c0;
+  e3 -= c2 * 9;
+  e3 -= c4 * 81;
+  e3 -= c6 * 729;
+  e3.divexact(3);
+
+  //   t1 = (d2 - d1) / 3 = c3 + 5 * c5, t2 = (e3 - d1) / 8 = c3 + 10 * c5
+  //   c5 = (t2 - t1) / 5, c3 = t1 - 5 * c5, c1 = d1 - c3 - c5
+  signed_places t1 = d2, c5 = e3;
+  t1 -= d1;
+  t1.divexact(3);
+  c5 -= d1;
+  c5.divexact(8);
+  c5 -= t1;
+  c5.divexact(5);
+  signed_places c3 = t1;
+  c3 -= c5 * 5;
+  signed_places c1 = d1;
+  c1 -= c3;
+  c1 -= c5;
+
+  // recompose
+  std::fill_n(res, n, 0);
+  std::copy(c0.places.begin(), c0.places.end(), res);
+  std::copy(c6.places.begin(), c6.places.end(), res + 6 * k);
+  add_at(res, n, c1, k);
+  add_at(res, n, c2, 2 * k);
+  add_at(res, n, c3, 3 * k);
+  add_at(res, n, c4, 4 * k);
+  add_at(res, n, c5, 5 * k);
+}
+
+// Toom-4 multiplication, an >= bn > 3 * ceil(an / 4)
+static void mul_toom4(uint32_t *res, const uint32_t *a, size_t an, const uint32_t *b, size_t bn)
+{
+  // a = a3 * x^3 + a2 * x^2 + a1 * x + a0 (same for b), x = B^k
+  bool square = a == b && an == bn;
+  size_t k = (an + 3) / 4;
+  std::vector<signed_places> a_at = evaluate_toom4(a, an, k), b_at;
+  if (!square)
+    b_at = evaluate_toom4(b, bn, k);
+
+  std::vector<signed_places> r = pointwise_products(a_at, b_at, square);
+  interpolate_toom4(res, an + bn, k, r);
+}
+
+// calls f(begin, end) for consecutive blocks of [0, n) no shorter than min_block,
+// concurrently if pool is given
+template<typename func>
+  static void for_blocks(thread_pool *pool, size_t n, size_t min_block, const func &f)
+  {
+    size_t blocks = pool == nullptr ? 1 : std::min(4 * (pool->size() + 1), n / min_block);
+    if (blocks <= 1)
+    {
+      f(0, n);
+      return;
+    }
+    size_t step = (n + blocks - 1) / blocks;
+    task_group group(*pool);
+    for (size_t begin = step; begin < n; begin += step)
+      group.run([&f, begin, step, n] { f(begin, std::min(n, begin + step)); });
+    f(0, step);
+    group.wait();
+  }
 
-big_integer & big_integer::operator<<=(int rhs)
+// prime p = c * 2^k + 1 < 2^31 with primitive root g for number-theoretic transform,
+// multiplications are done with Montgomery reduction
+struct ntt_prime
 {
-  return bit_shift(rhs);
-}
+  uint32_t p, g;
+  uint32_t p_neg_inv; // -p^(-1) mod 2^32
+  uint32_t r2;        // 2^64 mod p
 
-big_integer & big_integer::operator>>=(int rhs)
-{
-  return bit_shift(-rhs);
-}
+  ntt_prime(uint32_t p, uint32_t g) :
+    p(p), g(g), p_neg_inv(0 - inverse_mod_base(p)),
+    r2(static_cast<uint32_t>(((uint64_t{1} << 32) % p) * ((uint64_t{1} << 32) % p) % p))
+  {}
 
-big_integer & big_integer::bit_shift(int rhs)
-{
-  // rhs > 0 -> left shift
-  // rhs < 0 -> right shift
+  // x * 2^(-32) mod p, x < p^2
+  uint32_t reduce(uint64_t x) const
+  {
+    uint32_t m = static_cast<uint32_t>(x) * p_neg_inv;
+    uint32_t res = high_bytes(x + uint64_t{m} * p);
+    return std::min(res, res - p);
+  }
 
-  // [lsrc][rsrc]
-  //       <-> bits
-  //    [plce]
-  bool sign = sign_bit();
-  int places = rhs / PLACE_BITS, bits = rhs % PLACE_BITS;
-  if (rhs < 0 && bits != 0)
-    places--, bits += PLACE_BITS;
-  std::vector<place_t> new_data(std::max(data.size() + places + (bits > 0), size_t{1}),
-                                get_or_default(rhs < 0 ?
-                                  static_cast<int64_t>(data.size()) : -1));
-  for (size_t i = std::max(places, 0); i < data.size() + places + (bits > 0); i++)
+  // x + y mod p and x - y mod p (branchless: wrapped difference is greater than p)
+  uint32_t add(uint32_t x, uint32_t y) const
   {
-    // handle PLACE_BITS shift undefined behavior with cases
-    if (bits == 0)
-      new_data[i] = data[i - places];
+    uint32_t res = x + y;
+    return std::min(res, res - p);
+  }
+
+  uint32_t sub(uint32_t x, uint32_t y) const
+  {
+    uint32_t res = x + p - y;
+    return std::min(res, res - p);
+  }
+
+  // x * y * 2^(-32) mod p (x * y mod p if y is in Montgomery form)
+  uint32_t mul(uint32_t x, uint32_t y) const
+  {
+    return reduce(uint64_t{x} * y);
+  }
+
+  uint32_t to_montgomery(uint32_t x) const
+  {
+    return mul(x, r2);
+  }
+
+  uint32_t pow(uint32_t x, uint64_t e) const
+  {
+    uint64_t res = 1, base = x % p;
+    for (; e != 0; e >>= 1)
+    {
+      if (e & 1)
+        res = res * base % p;
+      base = base * base % p;
+    }
+    return static_cast<uint32_t>(res);
+  }
+
+  // powers [begin, end) of primitive len-th root (inverse) in Montgomery form
+  void fill_roots(uint32_t *roots, size_t len, bool inverse, size_t begin, size_t end) const
+  {
+    uint32_t w = pow(g, (p - 1) / len);
+    if (inverse)
+      w = pow(w, p - 2);
+    uint32_t w_m = to_montgomery(w);
+    if (begin < end)
+      roots[begin] = to_montgomery(pow(w, begin));
+    for (size_t j = begin + 1; j < end; j++)
+      roots[j] = mul(roots[j - 1], w_m);
+  }
+
+  // butterflies of forward (decimation in frequency) & inverse (decimation in time) transforms
+  void butterfly(uint32_t &x, uint32_t &y, uint32_t root, bool inverse) const
+  {
+    uint32_t u = x, v = y;
+    if (!inverse)
+    {
+      x = add(u, v);
+      y = mul(sub(u, v), root);
+    }
     else
     {
-      place_t
-        lsrc = get_or_default(static_cast<int64_t>(i) - places),
-        rsrc = get_or_default(static_cast<int64_t>(i) - places - 1);
-      new_data[i] = (lsrc << bits) | (rsrc >> (PLACE_BITS - bits));
+      v = mul(v, root);
+      x = add(u, v);
+      y = sub(u, v);
     }
   }
-  data = storage_t(new_data);
-  return correct_sign_bit(sign);
-}
 
-big_integer big_integer::operator+() const
-{
-  return *this;
-}
+  // level of transform of values[0, n) with butterflies on distance len / 2,
+  // butterflies [begin, end) of n / 2 are done
+  void level(uint32_t *values, size_t len, const uint32_t *roots, bool inverse,
+             size_t begin, size_t end) const
+  {
+    size_t half = len / 2;
+    for (size_t t = begin; t < end;)
+    {
+      size_t i = t / half * len, j = t % half, j_end = std::min(half, j + (end - t));
+      t += j_end - j;
+      if (!inverse)
+        for (; j < j_end; j++)
+          butterfly(values[i + j], values[i + j + half], roots[j], false);
+      else
+        for (; j < j_end; j++)
+          butterfly(values[i + j], values[i + j + half], roots[j], true);
+    }
+  }
 
-big_integer big_integer::operator-() const
-{
-  return ~ *this + 1;
-}
+  // in place transform of values[0, 2^log) reduced modulo p,
+  // forward one (decimation in frequency) leaves result in bit-reversed order,
+  // inverse one (decimation in time) takes it in that order and is not scaled by 2^(-log),
+  // so no permutations are needed for convolution
+  void transform(uint32_t *values, int log, bool inverse) const
+  {
+    size_t n = size_t{1} << log;
+    std::vector<uint32_t> roots(std::max(n / 2, size_t{1}));
+    for (size_t k = 0; k < size_t(log); k++)
+    {
+      // forward levels go from len = n down to 2, inverse ones -- backwards
+      size_t len = inverse ? size_t{2} << k : n >> k;
+      fill_roots(roots.data(), len, inverse, 0, len / 2);
+      level(values, len, roots.data(), inverse, 0, n / 2);
+    }
+  }
 
-big_integer big_integer::operator~() const
+  // transform with several threads: levels with len > part are split into blocks of butterflies,
+  // smaller ones are independent on each part of values
+  void transform(uint32_t *values, int log, bool inverse, thread_pool *pool) const;
+};
+
+// transform length limit: 2^NTT_MAX_LOG divides p - 1 for all primes
+static constexpr int NTT_MAX_LOG = 25;
+
+// parts of transform done by one thread (to fit in cache)
+static constexpr size_t NTT_MIN_PART = 1 << 12;
+
+void ntt_prime::transform(uint32_t *values, int log, bool inverse, thread_pool *pool) const
 {
-  return big_integer().place_wise(*this, [](place_t x, place_t y) { return ~y; });
+  size_t n = size_t{1} << log, part = n;
+  if (pool != nullptr)
+    while (part > NTT_MIN_PART && n / part < 4 * (pool->size() + 1))
+      part >>= 1;
+  if (part == n)
+  {
+    transform(values, log, inverse);
+    return;
+  }
+
+  int part_log = 0;
+  while ((size_t{1} << part_log) < part)
+    part_log++;
+  std::vector<uint32_t> roots(n / 2);
+  auto split_levels = [&]()
+  {
+    for (size_t k = 0; k < size_t(log - part_log); k++)
+    {
+      size_t len = inverse ? part << (k + 1) : n >> k;
+      for_blocks(pool, len / 2, NTT_MIN_PART, [&](size_t begin, size_t end)
+        {
+          fill_roots(roots.data(), len, inverse, begin, end);
+        });
+      for_blocks(pool, n / 2, NTT_MIN_PART, [&](size_t begin, size_t end)
+        {
+          level(values, len, roots.data(), inverse, begin, end);
+        });
+    }
+  };
+  auto part_levels = [&]()
+  {
+    for_blocks(pool, n / part, 1, [&](size_t begin, size_t end)
+      {
+        for (size_t i = begin; i < end; i++)
+          transform(values + i * part, part_log, inverse);
+      });
+  };
+
+  if (!inverse)
+  {
+    split_levels();
+    part_levels();
+  }
+  else
+  {
+    part_levels();
+    split_levels();
+  }
 }
 
-big_integer & big_integer::operator++()
+static const ntt_prime (&ntt_primes())[3]
 {
-  return *this += 1;
+  static const ntt_prime primes[3] =
+  {
+    {2013265921, 31}, // 15 * 2^27 + 1
+    {1811939329, 13}, // 27 * 2^26 + 1
+    {2113929217, 5}   // 63 * 2^25 + 1
+  };
+  return primes;
 }
 
-big_integer big_integer::operator++(int)
+// smallest log with 2^log >= n
+static int ceil_log2(size_t n)
 {
-  big_integer r = *this;
-  ++ *this;
-  return r;
+  int log = 0;
+  while ((size_t{1} << log) < n)
+    log++;
+  return log;
 }
 
-big_integer & big_integer::operator--()
+// f = forward transform of x[0, xn) modulo q with length 2^log
+static void ntt_forward(const ntt_prime &q, std::vector<uint32_t> &f, const uint32_t *x, size_t xn,
+                        int log, thread_pool *pool)
 {
-  return *this -= 1;
+  f.assign(size_t{1} << log, 0);
+  for_blocks(pool, xn, NTT_MIN_PART, [&](size_t begin, size_t end)
+    {
+      for (size_t i = begin; i < end; i++)
+        f[i] = x[i] % q.p;
+    });
+  q.transform(f.data(), log, false, pool);
 }
 
-big_integer big_integer::operator--(int)
+// f * 2^(-log) * 2^32: pointwise Montgomery products with it need no scaling before inverse transform
+static void ntt_scale(const ntt_prime &q, std::vector<uint32_t> &f, thread_pool *pool)
 {
-  big_integer r = *this;
-  -- *this;
-  return r;
+  // (f * 2^(-32)) * (n^(-1) * 2^64)
+  size_t n = f.size();
+  uint32_t scale = q.to_montgomery(q.to_montgomery(q.pow(static_cast<uint32_t>(n % q.p), q.p - 2)));
+  for_blocks(pool, n, NTT_MIN_PART, [&](size_t begin, size_t end)
+    {
+      for (size_t i = begin; i < end; i++)
+        f[i] = q.mul(f[i], scale);
+    });
 }
 
-big_integer operator+(big_integer a, const big_integer &b)
+// operand transformed & scaled for multiplication with results of length 2^log
+struct ntt_operand
+{
+  int log;
+  std::vector<uint32_t> residues[3];
+
+  ntt_operand(const uint32_t *b, size_t bn, int log, thread_pool *pool) : log(log)
+  {
+    for_blocks(pool, 3, 1, [&](size_t begin, size_t end)
+      {
+        for (size_t k = begin; k < end; k++)
+        {
+          ntt_forward(ntt_primes()[k], residues[k], b, bn, log, pool);
+          ntt_scale(ntt_primes()[k], residues[k], pool);
+        }
+      });
+  }
+};
+
+// multiplication with number-theoretic transforms modulo 3 primes & Chinese remainder theorem,
+// product coefficients are less than min(an, bn) * 2^64 <= 2^89 < p1 * p2 * p3,
+// an + bn <= 2^NTT_MAX_LOG (squaring needs one forward transform less),
+// transform of b may be given prepared for length of 2^ceil_log2(an + bn - 1),
+// all stages are split into blocks for threads of pool if it is given
+static void mul_ntt(uint32_t *res, const uint32_t *a, size_t an, const uint32_t *b, size_t bn,
+                    thread_pool *pool = nullptr, const ntt_operand *prepared = nullptr)
+{
+  bool square = prepared == nullptr && a == b && an == bn;
+  const ntt_prime (&primes)[3] = ntt_primes();
+  int log = ceil_log2(an + bn - 1);
+  size_t n = size_t{1} << log;
+  assert(prepared == nullptr || prepared->log == log);
+
+  // cyclic convolution modulo each prime
+  std::vector<uint32_t> residues[3];
+  for_blocks(pool, 3, 1, [&](size_t begin, size_t end)
+    {
+      for (size_t k = begin; k < end; k++)
+      {
+        const ntt_prime &q = primes[k];
+        std::vector<uint32_t> &fa = residues[k], fb;
+        ntt_forward(q, fa, a, an, log, pool);
+        if (prepared == nullptr)
+        {
+          if (square)
+            fb = fa;
+          else
+            ntt_forward(q, fb, b, bn, log, pool);
+          ntt_scale(q, fb, pool);
+        }
+        const uint32_t *scaled = prepared == nullptr ? fb.data() : prepared->residues[k].data();
+
+        for_blocks(pool, n, NTT_MIN_PART, [&](size_t begin, size_t end)
+          {
+            for (size_t i = begin; i < end; i++)
+              fa[i] = q.mul(fa[i], scaled[i]);
+          });
+        q.transform(fa.data(), log, true, pool);
+      }
+    });
+
+  // recombine coefficients with Garner's algorithm and propagate carries:
+  // c = y1 + p1 * y2 + p1 * p2 * y3
+  const uint64_t p1 = primes[0].p, p2 = primes[1].p, p3 = primes[2].p, p12 = p1 * p2;
+  const uint64_t
+    p1_inv = primes[1].pow(static_cast<uint32_t>(p1 % p2), p2 - 2),
+    p12_inv = primes[2].pow(static_cast<uint32_t>(p12 % p3), p3 - 2);
+  // res[begin, end) is set, carry (less than 2^96) to end place is returned in 3 places
+  auto recombine = [&](size_t begin, size_t end, uint32_t *carry_out)
+  {
+    // carry = carry_high * 2^64 + carry_low
+    uint64_t carry_low = 0, carry_high = 0;
+    for (size_t i = begin; i < end; i++)
+    {
+      uint64_t y1 = 0, y2 = 0, y3 = 0;
+      if (i < an + bn - 1)
+      {
+        y1 = residues[0][i];
+        y2 = (residues[1][i] + p2 - y1 % p2) % p2 * p1_inv % p2;
+        y3 = (residues[2][i] + p3 - (y1 + p1 * y2) % p3) % p3 * p12_inv % p3;
+      }
+      auto value = mul(p12, y3);
+      uint64_t low = value.first, high = value.second + carry_high;
+      low += y1 + p1 * y2;
+      high += low < y1 + p1 * y2;
+      low += carry_low;
+      high += low < carry_low;
+
+      res[i] = low_bytes(low);
+      carry_low = (low >> 32) | (high << 32);
+      carry_high = high >> 32;
+    }
+    carry_out[0] = low_bytes(carry_low);
+    carry_out[1] = high_bytes(carry_low);
+    carry_out[2] = low_bytes(carry_high);
+  };
+
+  // blocks are recombined independently, then carries are added in order
+  size_t size = an + bn, blocks = pool == nullptr ? 1 : std::min(4 * (pool->size() + 1), size / NTT_MIN_PART);
+  blocks = std::max(blocks, size_t{1});
+  size_t step = (size + blocks - 1) / blocks;
+  std::vector<uint32_t> carries(3 * blocks);
+  for_blocks(pool, blocks, 1, [&](size_t begin, size_t end)
+    {
+      for (size_t k = begin; k < end; k++)
+        recombine(k * step, std::min(size, (k + 1) * step), &carries[3 * k]);
+    });
+  for (size_t k = 1; k * step < size; k++)
+  {
+    size_t at = k * step, len = std::min(size_t{3}, size - at);
+    uint32_t carry = add_n(res + at, res + at, &carries[3 * (k - 1)], len);
+    add_1(res + at + len, res + at + len, size - at - len, carry);
+  }
+}
+
+// an >= bn
+static bool use_ntt(size_t an, size_t bn)
+{
+  if (an + bn > size_t{1} << NTT_MAX_LOG)
+    return false;
+  switch (big_integer::tuning::ntt)
+  {
+  case big_integer::tuning::mode::forced:
+    return true;
+  case big_integer::tuning::mode::disabled:
+    return false;
+  default:
+    return bn >= big_integer::tuning::ntt_threshold;
+  }
+}
+
+// multiplication of operands of different sizes, an >= 2 * bn:
+// longer one is split into chunks of bn places which are multiplied by balanced algorithms,
+// products overlapping with previous ones in low halves are accumulated in res
+static void mul_unbalanced(uint32_t *res, const uint32_t *a, size_t an, const uint32_t *b, size_t bn)
+{
+  mul_places(res, a, bn, b, bn);
+  std::vector<uint32_t> product(2 * bn);
+  size_t at = bn;
+  for (; at + bn <= an; at += bn)
+  {
+    mul_places(product.data(), a + at, bn, b, bn);
+    uint32_t carry = add_n(res + at, res + at, product.data(), bn);
+    add_1(res + at + bn, product.data() + bn, bn, carry);
+  }
+
+  // last chunk is shorter than b
+  size_t rest = an - at;
+  if (rest != 0)
+  {
+    mul_places(product.data(), b, bn, a + at, rest);
+    uint32_t carry = add_n(res + at, res + at, product.data(), bn);
+    add_1(res + at + bn, product.data() + bn, rest, carry);
+  }
+}
+
+// res[0, 2n) = a[0, n)^2, res must not overlap operand
+static void sqr_places(uint32_t *res, const uint32_t *a, size_t n)
+{
+  std::fill_n(res, 2 * n, 0);
+  n = normalized_size(a, n);
+
+  if (n == 0)
+    return;
+  if (use_ntt(n, n))
+    mul_ntt(res, a, n, a, n);
+  else if (n < big_integer::tuning::sqr_karatsuba_threshold)
+    sqr_basecase(res, a, n);
+  else if (n >= big_integer::tuning::toom4_threshold)
+    mul_toom4(res, a, n, a, n);
+  else if (n >= big_integer::tuning::toom3_threshold)
+    mul_toom3(res, a, n, a, n);
+  else
+    sqr_karatsuba(res, a, n);
+}
+
+// res[0, an + bn) = a[0, an) * b[0, bn), res must not overlap operands
+static void mul_places(uint32_t *res, const uint32_t *a, size_t an, const uint32_t *b, size_t bn)
+{
+  if (a == b && an == bn)
+  {
+    sqr_places(res, a, an);
+    return;
+  }
+
+  std::fill_n(res, an + bn, 0);
+  an = normalized_size(a, an);
+  bn = normalized_size(b, bn);
+  if (an < bn)
+  {
+    std::swap(a, b);
+    std::swap(an, bn);
+  }
+
+  if (bn == 0)
+    return;
+  if (use_ntt(an, bn))
+    mul_ntt(res, a, an, b, bn);
+  else if (bn < big_integer::tuning::karatsuba_threshold)
+    mul_basecase(res, a, an, b, bn);
+  else if (bn >= big_integer::tuning::toom4_threshold && bn > 3 * ((an + 3) / 4))
+    mul_toom4(res, a, an, b, bn);
+  else if (bn >= big_integer::tuning::toom3_threshold && bn > 2 * ((an + 2) / 3))
+    mul_toom3(res, a, an, b, bn);
+  else if (bn > (an + 1) / 2)
+    mul_karatsuba(res, a, an, b, bn);
+  else
+    mul_unbalanced(res, a, an, b, bn);
+}
+
+/* Short products: only a part of places of product is computed */
+
+// res[0, n) = a[0, an) * b[0, bn) mod B^n (low product),
+// Mulders' algorithm: a = a1 * B^k + a0, b = b1 * B^k + b0 with k > n / 2,
+// a1 * b1 is dropped, a1 * b0 & a0 * b1 are low products themselves,
+// rows of basecase are cut at place n, res must not overlap operands
+static void mul_low_places(uint32_t *res, const uint32_t *a, size_t an, const uint32_t *b, size_t bn, size_t n)
+{
+  std::fill_n(res, n, 0);
+  an = normalized_size(a, std::min(an, n));
+  bn = normalized_size(b, std::min(bn, n));
+  if (an < bn)
+  {
+    std::swap(a, b);
+    std::swap(an, bn);
+  }
+
+  if (bn == 0)
+    return;
+  if (an + bn <= n)
+    mul_places(res, a, an, b, bn);
+  else if (bn < big_integer::tuning::karatsuba_threshold && wide_basecase())
+  {
+    // basecase with 64-bit words is faster even with all products
+    std::vector<uint32_t> full(an + bn);
+    mul_basecase(full.data(), a, an, b, bn);
+    std::copy_n(full.begin(), n, res);
+  }
+  else if (bn < big_integer::tuning::karatsuba_threshold)
+    for (size_t i = 0; i < bn; i++)
+    {
+      size_t len = std::min(an, n - i);
+      uint32_t carry = addmul_1(res + i, a, len, b[i]);
+      if (i + len < n)
+        res[i + len] = carry;
+    }
+  else
+  {
+    size_t k = std::max(n / 2 + 1, n * 7 / 10), a0n = std::min(an, k), b0n = std::min(bn, k);
+    std::vector<uint32_t> full(a0n + b0n), cross(n - k);
+    mul_places(full.data(), a, a0n, b, b0n);
+    std::copy_n(full.begin(), std::min(n, full.size()), res);
+    if (an > k)
+    {
+      mul_low_places(cross.data(), a + k, an - k, b, bn, n - k);
+      add_n(res + k, res + k, cross.data(), n - k);
+    }
+    if (bn > k)
+    {
+      mul_low_places(cross.data(), b + k, bn - k, a, an, n - k);
+      add_n(res + k, res + k, cross.data(), n - k);
+    }
+  }
+}
+
+// res[n - 1, 2n) is set to high part of a[0, n) * b[0, n) with error less than 2n * B^n
+// (computed value is not greater than exact one), Mulders' algorithm:
+// a = a1 * B^l + a0, b = b1 * B^l + b0 with l < n / 2,
+// a1 * b1 is computed fully, a0 * b0 is dropped,
+// only high parts of cross products (with top l places of a1 or b1) are added,
+// basecase rows skip products of a[i] * b[j] with i + j < n - 1
+static void mul_high_approx(uint32_t *res, const uint32_t *a, const uint32_t *b, size_t n)
+{
+  if (n < std::max(big_integer::tuning::karatsuba_threshold, size_t{8}) && wide_basecase())
+  {
+    std::vector<uint32_t> full(2 * n);
+    mul_basecase(full.data(), a, n, b, n);
+    std::copy(full.begin() + (n - 1), full.end(), res + (n - 1));
+    return;
+  }
+  if (n < std::max(big_integer::tuning::karatsuba_threshold, size_t{8}))
+  {
+    // dropped products are less than n * B^n in total
+    res += n - 1;
+    uint64_t product = uint64_t{a[n - 1]} * b[0];
+    res[0] = low_bytes(product);
+    res[1] = high_bytes(product);
+    for (size_t i = 1; i < n; i++)
+      res[i + 1] = addmul_1(res, a + (n - i - 1), i + 1, b[i]);
+    return;
+  }
+
+  // error is less than 2 * 2l * B^n of cross products & 3 * B^n of dropped products (l < n / 2 - 1)
+  size_t k = std::max((n + 4) / 2, n * 7 / 10), l = n - k;
+  mul_places(res + 2 * l, a + l, k, b + l, k);
+  std::vector<uint32_t> cross(2 * l);
+  mul_high_approx(cross.data(), a + k, b, l);
+  uint32_t carry = add_n(res + n - 1, res + n - 1, cross.data() + l - 1, l + 1);
+  mul_high_approx(cross.data(), a, b + k, l);
+  carry += add_n(res + n - 1, res + n - 1, cross.data() + l - 1, l + 1);
+  add_1(res + n + l, res + n + l, k, carry);
+}
+
+// res[0, an + bn - n) = a[0, an) * b[0, bn) / B^n (high product), res must not overlap operands
+static void mul_high_places(uint32_t *res, const uint32_t *a, size_t an, const uint32_t *b, size_t bn, size_t n)
+{
+  size_t size = an + bn - n, m = std::max(an, bn);
+  if (2 * n > m && m >= big_integer::tuning::karatsuba_threshold)
+  {
+    // operands are padded to m places & shifted by s places,
+    // so that there are at least 2 guard places in approximate high part:
+    // a * B^s * b * B^s / B^(n + 2s) = a * b / B^n, n + 2s >= m + s + 1
+    size_t s = m + 1 > n ? m + 1 - n : 0, ms = m + s, ns = n + 2 * s;
+    std::vector<uint32_t> pa(ms, 0), pb(ms, 0), approx(2 * ms);
+    std::copy_n(a, an, pa.begin() + s);
+    std::copy_n(b, bn, pb.begin() + s);
+    mul_high_approx(approx.data(), pa.data(), pb.data(), ms);
+
+    // exact result is the same if adding error bound to guard places gives no carry
+    std::vector<uint32_t> guard(approx.begin() + (ms - 1), approx.begin() + ns);
+    if (add_1(guard.data() + 1, guard.data() + 1, guard.size() - 1, static_cast<uint32_t>(2 * ms)) == 0)
+    {
+      std::copy_n(approx.begin() + ns, size, res);
+      return;
+    }
+  }
+
+  std::vector<uint32_t> product(an + bn);
+  mul_places(product.data(), a, an, b, bn);
+  std::copy_n(product.begin() + n, size, res);
+}
+
+// pool of tuning::threads - 1 workers for parallel multiplication (null for one thread),
+// it is recreated when number of threads changes
+static std::shared_ptr<thread_pool> get_thread_pool()
+{
+  static std::mutex m;
+  static std::shared_ptr<thread_pool> pool;
+
+  size_t threads = big_integer::tuning::threads;
+  if (threads == 0)
+    threads = std::thread::hardware_concurrency();
+  std::lock_guard<std::mutex> lock(m);
+  if (threads <= 1)
+    pool.reset();
+  else if (pool == nullptr || pool->size() != threads - 1)
+    pool = std::make_shared<thread_pool>(threads - 1);
+  return pool;
+}
+
+// an >= bn >= 1
+static bool use_parallel(size_t an, size_t bn)
+{
+  switch (big_integer::tuning::parallel)
+  {
+  case big_integer::tuning::mode::forced:
+    return true;
+  case big_integer::tuning::mode::disabled:
+    return false;
+  default:
+    return bn >= big_integer::tuning::karatsuba_threshold && an + bn >= big_integer::tuning::parallel_threshold;
+  }
+}
+
+// res[0, an + bn) = a[0, an) * b[0, bn) with threads of pool,
+// an >= bn >= 1 are normalized sizes, res is filled with zeros and must not overlap operands
+static void mul_parallel(uint32_t *res, const uint32_t *a, size_t an, const uint32_t *b, size_t bn,
+                         thread_pool &pool)
+{
+  if (use_ntt(an, bn))
+  {
+    mul_ntt(res, a, an, b, bn, &pool);
+    return;
+  }
+
+  // split longer operand into blocks no shorter than the other one:
+  // products of even blocks do not overlap and are written in place, odd ones are added afterwards
+  size_t blocks = std::min(an / bn, 4 * (pool.size() + 1));
+  if (blocks < 2)
+  {
+    mul_places(res, a, an, b, bn);
+    return;
+  }
+  size_t step = (an + blocks - 1) / blocks;
+  blocks = (an + step - 1) / step;
+  std::vector<std::vector<uint32_t>> odd(blocks / 2);
+  for_blocks(&pool, blocks, 1, [&](size_t begin, size_t end)
+    {
+      for (size_t k = begin; k < end; k++)
+      {
+        size_t len = std::min(step, an - k * step);
+        uint32_t *dst = res + k * step;
+        if (k % 2 == 1)
+        {
+          odd[k / 2].resize(len + bn);
+          dst = odd[k / 2].data();
+        }
+        mul_places(dst, a + k * step, len, b, bn);
+      }
+    });
+  for (size_t k = 1; k < blocks; k += 2)
+  {
+    const std::vector<uint32_t> &product = odd[k / 2];
+    size_t at = k * step, len = product.size();
+    uint32_t carry = add_n(res + at, res + at, product.data(), len);
+    add_1(res + at + len, res + at + len, an + bn - at - len, carry);
+  }
+}
+
+// res[0, an + bn) = a[0, an) * b[0, bn) for normalized magnitudes,
+// in several threads for large products, res must not overlap operands
+static void mul_top(uint32_t *res, const uint32_t *a, size_t an, const uint32_t *b, size_t bn)
+{
+  if (an < bn)
+  {
+    std::swap(a, b);
+    std::swap(an, bn);
+  }
+  if (bn != 0 && use_parallel(an, bn))
+    if (std::shared_ptr<thread_pool> pool = get_thread_pool())
+    {
+      std::fill_n(res, an + bn, 0);
+      mul_parallel(res, a, an, b, bn, *pool);
+      return;
+    }
+  mul_places(res, a, an, b, bn);
+}
+
+/* Products by fixed operand (factor of big_integer_multiplier): its parts for Karatsuba,
+ * Toom-Cook & unbalanced splits are evaluated once for each split size & kept with it */
+
+// sum of halves of a[0, an) split into parts of h places (an > h) for Karatsuba: a0 + a1
+static std::vector<signed_places> evaluate_karatsuba(const uint32_t *a, size_t an, size_t h)
+{
+  std::vector<signed_places> at(1, signed_places(a, h));
+  at[0] += signed_places(a + h, an - h);
+  return at;
+}
+
+// chunks of a[0, an) of k places each (the last one may be shorter)
+static std::vector<signed_places> evaluate_chunks(const uint32_t *a, size_t an, size_t k)
+{
+  std::vector<signed_places> at;
+  for (size_t i = 0; i < an; i += k)
+    at.emplace_back(a + i, std::min(k, an - i));
+  return at;
+}
+
+struct fixed_operand
+{
+  enum class split { karatsuba, toom3, toom4, chunks };
+  using parts_t = std::vector<std::unique_ptr<fixed_operand>>;
+
+  // at most this many splits are kept for operand, others are evaluated for each product
+  static constexpr size_t MAX_SPLITS = 4;
+
+  signed_places value;
+
+  // parts by split & size of split
+  std::mutex m;
+  std::map<std::pair<split, size_t>, std::shared_ptr<const parts_t>> splits;
+
+  explicit fixed_operand(signed_places value) : value(std::move(value))
+  {}
+
+  std::shared_ptr<const parts_t> get_parts(split kind, size_t k)
+  {
+    {
+      std::lock_guard<std::mutex> lock(m);
+      auto it = splits.find({kind, k});
+      if (it != splits.end())
+        return it->second;
+    }
+    // evaluated without lock, concurrent evaluation of the same split is not harmful
+    const uint32_t *a = value.places.data();
+    size_t n = value.places.size();
+    std::vector<signed_places> values =
+      kind == split::karatsuba ? evaluate_karatsuba(a, n, k) :
+      kind == split::toom3 ? evaluate_toom3(a, n, k) :
+      kind == split::toom4 ? evaluate_toom4(a, n, k) :
+      evaluate_chunks(a, n, k);
+    auto parts = std::make_shared<parts_t>();
+    for (signed_places &part : values)
+      parts->push_back(std::make_unique<fixed_operand>(std::move(part)));
+
+    std::lock_guard<std::mutex> lock(m);
+    if (splits.size() >= MAX_SPLITS)
+      return parts;
+    return splits.emplace(std::make_pair(kind, k), std::move(parts)).first->second;
+  }
+};
+
+static void mul_fixed(uint32_t *res, const uint32_t *a, size_t an, fixed_operand &b);
+
+static signed_places operator*(const signed_places &a, fixed_operand &b)
+{
+  signed_places res;
+  res.places.resize(a.places.size() + b.value.places.size());
+  mul_fixed(res.places.data(), a.places.data(), a.places.size(), b);
+  res.negative = a.negative ^ b.value.negative;
+  return res.normalize();
+}
+
+// res[0, an + bn) = a[0, an) * |b| (bn places), algorithm is chosen as in mul_places,
+// parts of b are taken from its splits: Toom-Cook parts are fixed operands of subproducts,
+// Karatsuba sum b0 + b1 is multiplied as usual, unbalanced products split a into chunks
+// multiplied by b or b into chunks multiplied by a, res must not overlap operands
+static void mul_fixed(uint32_t *res, const uint32_t *a, size_t an, fixed_operand &b)
+{
+  const uint32_t *bp = b.value.places.data();
+  size_t bn = b.value.places.size();
+  std::fill_n(res, an + bn, 0);
+  an = normalized_size(a, an);
+  size_t lo = std::min(an, bn), hi = std::max(an, bn), n = an + bn;
+  if (lo < big_integer::tuning::karatsuba_threshold || use_ntt(hi, lo))
+  {
+    if (an >= bn)
+      mul_places(res, a, an, bp, bn);
+    else
+      mul_places(res, bp, bn, a, an);
+    return;
+  }
+
+  fixed_operand::split kind;
+  size_t k;
+  if (lo >= big_integer::tuning::toom4_threshold && lo > 3 * ((hi + 3) / 4))
+    kind = fixed_operand::split::toom4, k = (hi + 3) / 4;
+  else if (lo >= big_integer::tuning::toom3_threshold && lo > 2 * ((hi + 2) / 3))
+    kind = fixed_operand::split::toom3, k = (hi + 2) / 3;
+  else if (lo > (hi + 1) / 2)
+    kind = fixed_operand::split::karatsuba, k = (hi + 1) / 2;
+  else if (an > bn)
+  {
+    // chunks of a multiplied by b
+    std::vector<uint32_t> product(2 * bn);
+    for (size_t at = 0; at < an; at += bn)
+    {
+      size_t len = std::min(bn, an - at);
+      mul_fixed(product.data(), a + at, len, b);
+      uint32_t carry = add_n(res + at, res + at, product.data(), len + bn);
+      add_1(res + at + len + bn, res + at + len + bn, n - at - len - bn, carry);
+    }
+    return;
+  }
+  else
+    kind = fixed_operand::split::chunks, k = an;
+
+  std::shared_ptr<const fixed_operand::parts_t> parts = b.get_parts(kind, k);
+  std::vector<signed_places> at;
+  switch (kind)
+  {
+  case fixed_operand::split::karatsuba:
+  {
+    const std::vector<uint32_t> &sum = (*parts)[0]->value.places;
+    mul_karatsuba(res, a, an, bp, bn, sum.data(), sum.size());
+    return;
+  }
+  case fixed_operand::split::toom3:
+    at = evaluate_toom3(a, an, k);
+    break;
+  case fixed_operand::split::toom4:
+    at = evaluate_toom4(a, an, k);
+    break;
+  case fixed_operand::split::chunks:
+  {
+    // a multiplied by chunks of b
+    std::vector<uint32_t> product(2 * an);
+    for (size_t i = 0; i < parts->size(); i++)
+    {
+      fixed_operand &chunk = *(*parts)[i];
+      size_t at = i * k, len = chunk.value.places.size();
+      mul_fixed(product.data(), a, an, chunk);
+      uint32_t carry = add_n(res + at, res + at, product.data(), an + len);
+      add_1(res + at + an + len, res + at + an + len, n - at - an - len, carry);
+    }
+    return;
+  }
+  }
+
+  std::vector<signed_places> r(at.size());
+  for (size_t i = 0; i < at.size(); i++)
+    r[i] = at[i] * *(*parts)[i];
+
+  if (kind == fixed_operand::split::toom3)
+    interpolate_toom3(res, n, k, r);
+  else
+    interpolate_toom4(res, n, k, r);
+}
+
+/* Division of places: d[0, m) is normalized (highest bit is set), m >= 2,
+ * r[0, n + 1) is dividend with r[n - m + 1, n + 1) < d, quotient q has n - m + 1 places,
+ * remainder is left in r[0, m) & places from m are zeroed */
+
+// division by 2 places with 3/2 division for each place of quotient,
+// inv is reciprocal_3_2 of divisor
+static void div_2(uint32_t *q, uint32_t *r, size_t n, const uint32_t *d, uint32_t inv)
+{
+  uint64_t rem = (uint64_t{r[n]} << 32) | r[n - 1];
+  for (size_t k = n - 1; k-- > 0;)
+  {
+    auto qr = div3_2(r[k], low_bytes(rem), high_bytes(rem), d[0], d[1], inv);
+    q[k] = qr.first;
+    rem = qr.second;
+  }
+  r[0] = low_bytes(rem);
+  r[1] = high_bytes(rem);
+  std::fill_n(r + 2, n - 1, 0);
+}
+
+// schoolbook division (Knuth's algorithm D done in place in remainder places),
+// inv is reciprocal_3_2 of 2 high places of divisor
+static void div_basecase(uint32_t *q, uint32_t *r, size_t n, const uint32_t *d, size_t m, uint32_t inv)
+{
+  if (m == 2)
+  {
+    div_2(q, r, n, d, inv);
+    return;
+  }
+
+  // 2 leading digits of divisor for quotient digits estimate
+  uint32_t d2_high = d[m - 1];
+  uint32_t d2_low = d[m - 2];
+  for (size_t k = n - m + 1; k-- > 0;)
+  {
+    uint32_t *rk = r + k;
+    // obtain k-th digit estimate from 3 leading digits of remainder,
+    // it is greater than digit by at most 1
+    uint32_t qt = std::numeric_limits<uint32_t>::max();
+    if (rk[m] != d2_high || rk[m - 1] != d2_low)
+      qt = div3_2(rk[m - 2], rk[m - 1], rk[m], d2_low, d2_high, inv).first;
+    // subtract d * qt from m + 1 places of remainder
+    uint32_t borrow = submul_1(rk, d, m, qt);
+    if (rk[m] < borrow)
+    {
+      // remainder is negative, estimate was too big: add divisor back
+      qt--;
+      add_n(rk, rk, d, m);
+    }
+    // high place of remainder is zero now
+    rk[m] = 0;
+    // set digit in quotient
+    q[k] = qt;
+  }
+}
+
+// reciprocal_3_2 of 2 high places of normalized d[0, m)
+static uint32_t reciprocal_3_2(const uint32_t *d, size_t m)
+{
+  return reciprocal_3_2(d[m - 2], d[m - 1]);
+}
+
+// res[0, an + bn) = a[0, an) * b[0, bn) for not normalized operands
+static void mul_any(uint32_t *res, const uint32_t *a, size_t an, const uint32_t *b, size_t bn)
+{
+  size_t an_norm = normalized_size(a, an), bn_norm = normalized_size(b, bn);
+  std::fill(res + an_norm + bn_norm, res + an + bn, 0);
+  mul_top(res, a, an_norm, b, bn_norm);
+}
+
+// w[0, 2m) / d[0, m): quotient is qh * B^m + q[0, m), qh is returned, remainder is left in w[0, m),
+// w[m, 2m) may be greater than d here, scratch has m places,
+// inv is reciprocal_3_2 of d (the same for its high parts)
+// (Burnikel & Ziegler recursive division: 3n / 2n steps for high & low halves of quotient)
+static uint32_t div_dc_n(uint32_t *q, uint32_t *w, const uint32_t *d, size_t m, uint32_t inv,
+                         uint32_t *scratch)
+{
+  const uint32_t one = 1;
+  if (m < std::max(big_integer::tuning::burnikel_ziegler_threshold, size_t{4}))
+  {
+    uint32_t qh = compare_n(w + m, d, m) >= 0;
+    if (qh != 0)
+      sub_n(w + m, w + m, d, m);
+    div_basecase(q, w, 2 * m - 1, d, m, inv);
+    return qh;
+  }
+
+  size_t lo = m / 2, hi = m - lo;
+  // high half: w[lo, 2m) / d with quotient from w[2lo, 2m) / d[lo, m),
+  // remainder is corrected with product of quotient & low places of divisor
+  uint32_t qh = div_dc_n(q + lo, w + 2 * lo, d + lo, hi, inv, scratch);
+  mul_any(scratch, q + lo, hi, d, lo);
+  uint32_t borrow = sub_n(w + lo, w + lo, scratch, m);
+  if (qh != 0)
+    borrow += sub_n(w + m, w + m, d, lo);
+  while (borrow != 0)
+  {
+    qh -= sub(q + lo, q + lo, hi, &one, 1);
+    borrow -= add_n(w + lo, w + lo, d, m);
+  }
+
+  // low half: w[0, m + lo) / d in the same way
+  uint32_t ql = div_dc_n(q, w + hi, d + hi, lo, inv, scratch);
+  mul_any(scratch, d, hi, q, lo);
+  borrow = sub_n(w, w, scratch, m);
+  if (ql != 0)
+    borrow += sub_n(w + lo, w + lo, d, hi);
+  while (borrow != 0)
+  {
+    sub(q, q, lo, &one, 1);
+    borrow -= add_n(w, w, d, m);
+  }
+  return qh;
+}
+
+// recursive division by blocks of m places of quotient (as digits of schoolbook division),
+// high block may be shorter: it is divided by high places of divisor & corrected
+static void div_dc(uint32_t *q, uint32_t *r, size_t n, const uint32_t *d, size_t m)
+{
+  const uint32_t one = 1;
+  const uint32_t inv = reciprocal_3_2(d, m);
+  std::vector<uint32_t> scratch(m);
+  size_t qn = n - m + 1;
+  for (size_t i = qn; i > 0;)
+  {
+    size_t t = i % m == 0 ? m : i % m;
+    i -= t;
+    // window w[0, m + t) with w[t, m + t) < d gives quotient block of t places
+    uint32_t *w = r + i, *qb = q + i;
+    if (t < std::max(big_integer::tuning::burnikel_ziegler_threshold, size_t{4}))
+      div_basecase(qb, w, m + t - 1, d, m, inv);
+    else if (t == m)
+      div_dc_n(qb, w, d, m, inv, scratch.data());
+    else
+    {
+      uint32_t qh = div_dc_n(qb, w + (m - t), d + (m - t), t, inv, scratch.data());
+      mul_any(scratch.data(), qb, t, d, m - t);
+      uint32_t borrow = sub_n(w, w, scratch.data(), m);
+      if (qh != 0)
+        borrow += sub_n(w + t, w + t, d, m - t);
+      while (borrow != 0)
+      {
+        sub(qb, qb, t, &one, 1);
+        borrow -= add_n(w, w, d, m);
+      }
+    }
+    // places from m are not used by next blocks
+    std::fill_n(w + m, t, 0);
+  }
+}
+
+// x[0, n + 1) = approximate reciprocal B^n + x' of normalized a[0, n), n >= 2,
+// a * x < B^(2n) <= a * (x + 2) (Newton iteration from reciprocal of high half,
+// see Brent & Zimmermann, "Modern Computer Arithmetic", algorithm 3.5)
+static void invert_places(uint32_t *x, const uint32_t *a, size_t n)
+{
+  if (n < std::max(big_integer::tuning::newton_division_threshold, size_t{4}))
+  {
+    // x = (B^(2n) - 1) / a (schoolbook division is used for short blocks of quotient)
+    std::vector<uint32_t> r(2 * n + 1, std::numeric_limits<uint32_t>::max());
+    r[2 * n] = 0;
+    div_dc(x, r.data(), 2 * n, a, n);
+    return;
+  }
+
+  size_t l = (n - 1) / 2, h = n - l;
+  std::vector<uint32_t> xh(h + 1), t(n + h + 1);
+  invert_places(xh.data(), a + l, h);
+
+  // t = a * xh < B^(n + h)
+  mul_any(t.data(), a, n, xh.data(), h + 1);
+  while (t[n + h] != 0)
+  {
+    const uint32_t one = 1;
+    sub(xh.data(), xh.data(), h + 1, &one, 1);
+    sub(t.data(), t.data(), n + h + 1, a, n);
+  }
+  // t = B^(n + h) - t < 2a
+  negate_n(t.data(), n + h);
+
+  // x = xh * B^l + (t / B^l) * xh / B^(2h - l)
+  std::vector<uint32_t> u(2 * h + 2);
+  mul_any(u.data(), t.data() + l, h + 1, xh.data(), h + 1);
+  std::fill_n(x, l, 0);
+  std::copy_n(xh.data(), h + 1, x + l);
+  add(x, x, n + 1, u.data() + (2 * h - l), l + 2);
+}
+
+// division by multiplication with reciprocal of high places of divisor,
+// quotient is found by blocks of places (as digits of schoolbook division),
+// reciprocal of whole divisor may be given precomputed with invert_places
+static void div_newton(uint32_t *q, uint32_t *r, size_t n, const uint32_t *d, size_t m,
+                       const uint32_t *reciprocal = nullptr)
+{
+  // reciprocal of k high places of divisor is enough for blocks of k places
+  // (with k < m blocks are shorter than k)
+  size_t qn = n - m + 1, k = reciprocal != nullptr ? m : std::min(m, qn + 1);
+  std::vector<uint32_t> computed;
+  const uint32_t *x = reciprocal;
+  if (x == nullptr)
+  {
+    computed.resize(k + 1);
+    invert_places(computed.data(), d + (m - k), k);
+    x = computed.data();
+  }
+
+  size_t block = k < m ? k - 1 : k;
+  std::vector<uint32_t> estimate(block + 1), product(m + 1);
+  const uint32_t one = 1;
+  for (size_t i = qn; i > 0;)
+  {
+    size_t t = std::min(block, i);
+    i -= t;
+    // window w[0, m + t) with w[t, m + t) < d gives quotient block of t places
+    uint32_t *w = r + i, *qb = q + i;
+
+    // estimate from t + 1 high places of window & reciprocal,
+    // it is less than block by a few units (or greater by at most 2 if divisor is truncated)
+    mul_high_places(estimate.data(), w + (m - 1), t + 1, x + (k - t), t + 1, t + 1);
+    if (estimate[t] != 0)
+      std::fill_n(estimate.data(), t, std::numeric_limits<uint32_t>::max());
+    std::copy_n(estimate.data(), t, qb);
+
+    // correct estimate with remainder, it is far less than B^(m + 1) / 2 in absolute value,
+    // so only its low m + 1 places are computed (high one is signed)
+    mul_low_places(product.data(), qb, t, d, m, m + 1);
+    sub_n(w, w, product.data(), m + 1);
+    while (static_cast<int32_t>(w[m]) < 0)
+    {
+      sub(qb, qb, t, &one, 1);
+      w[m] += add_n(w, w, d, m);
+    }
+    while (w[m] != 0 || compare_n(w, d, m) >= 0)
+    {
+      add_1(qb, qb, t, 1);
+      w[m] -= sub_n(w, w, d, m);
+    }
+    std::fill_n(w + m, t, 0);
+  }
+}
+
+/* Exact division (Hensel's division from low places):
+ * quotient of exact division by odd b is a * b^-1 mod B^k for large enough k */
+
+// q[0, n) = a[0, n) * b[0, bn)^-1 mod B^n, a is destroyed, inv = b[0]^-1 mod B,
+// recursive on halves of quotient (as Burnikel-Ziegler division from low places),
+// scratch has n places
+static void divexact_dc(uint32_t *q, uint32_t *a, size_t n, const uint32_t *b, size_t bn, uint32_t inv,
+                        uint32_t *scratch)
+{
+  bn = std::min(bn, n);
+  if (n < std::max(big_integer::tuning::burnikel_ziegler_threshold, size_t{2}))
+  {
+    // basecase: each place of quotient zeroes a place of a
+    for (size_t i = 0; i < n; i++)
+    {
+      q[i] = a[i] * inv;
+      size_t len = std::min(bn, n - i);
+      uint32_t borrow = submul_1(a + i, b, len, q[i]);
+      for (size_t j = i + len; borrow != 0 && j < n; j++)
+      {
+        uint32_t place = a[j];
+        a[j] = place - borrow;
+        borrow = place < borrow;
+      }
+    }
+    return;
+  }
+
+  // a = a1 * B^lo + a0, q0 = a0 / b mod B^lo, q1 = (a - q0 * b) / B^lo / b mod B^hi,
+  // low places of a - q0 * b are zero
+  size_t lo = n / 2, hi = n - lo;
+  divexact_dc(q, a, lo, b, bn, inv, scratch);
+  mul_low_places(scratch, q, lo, b, bn, n);
+  sub_n(a + lo, a + lo, scratch + lo, hi);
+  divexact_dc(q + lo, a + lo, hi, b, bn, inv, scratch);
+}
+
+// q[0, an - bn + 1) = a[0, an) / b[0, bn) for a divisible by b with odd b[0],
+// q must not overlap operands
+static void divexact_places(uint32_t *q, const uint32_t *a, size_t an, const uint32_t *b, size_t bn)
+{
+  // places of a from qn do not affect quotient
+  size_t qn = an - bn + 1;
+  std::vector<uint32_t> r(a, a + qn), scratch(qn);
+  divexact_dc(q, r.data(), qn, b, bn, inverse_mod_base(b[0]), scratch.data());
+}
+
+/***
+ * Rest of arithmetic operators for big_integer
+ ***/
+
+big_integer & big_integer::operator+=(const big_integer &rhs)
+{
+  bool old_sign = sign_bit(), rhs_sign = rhs.sign_bit();
+  bool carry = 0;
+  iterate(rhs, [&](place_t l, place_t r) { return addc(l, r, carry); });
+  if (old_sign == rhs_sign)
+    correct_sign_bit(old_sign);
+
+  // 1... + 1... => 0... + carry  | new place
+  //                1... + carry  |
+  // 0... + 0... => 1... no carry | new place
+  //                0... no carry |
+  // 1... + 0... => 1... no carry |
+  //                0... + carry  |
+
+  return shrink();
+}
+
+big_integer & big_integer::operator-=(const big_integer &rhs)
+{
+  return *this += -rhs;
+}
+
+// multiplication by a positive integer that fits into place_t
+big_integer & big_integer::short_multiply(place_t rhs)
+{
+  bool old_sign = make_absolute();
+
+  place_t carry = mul_1(data.data(), data.data(), size(), rhs);
+  correct_sign_bit(0, carry);
+  return revert_sign(old_sign);
+}
+
+big_integer & big_integer::operator*=(const big_integer &rhs)
+{
+  if (data.is_same_data(rhs.data))
+    return square();
+
+  // rhs may alias *this, so both magnitudes are obtained before writing
+  bool sign = sign_bit() ^ rhs.sign_bit();
+  magnitude l = get_magnitude(), r = rhs.get_magnitude();
+
+  // extra zero place for sign
+  storage_t res(l.size + r.size + 1, 0);
+  mul_top(res.data(), l.places, l.size, r.places, r.size);
+  data.swap(res);
+  return set_magnitude_sign(sign);
+}
+
+big_integer & big_integer::square()
+{
+  magnitude m = get_magnitude();
+
+  // extra zero place for sign
+  storage_t res(2 * m.size + 1, 0);
+  mul_top(res.data(), m.places, m.size, m.places, m.size);
+  data.swap(res);
+  return set_magnitude_sign(0);
+}
+
+big_integer sqr(const big_integer &a)
+{
+  big_integer res = a;
+  return res.square();
+}
+
+big_integer mul_low(const big_integer &a, const big_integer &b, size_t n)
+{
+  return mul_middle(a, b, 0, n);
+}
+
+big_integer mul_high(const big_integer &a, const big_integer &b, size_t n)
+{
+  return mul_middle(a, b, n, std::numeric_limits<size_t>::max());
+}
+
+big_integer mul_middle(const big_integer &a, const big_integer &b, size_t lo, size_t hi)
+{
+  bool sign = a.sign_bit() ^ b.sign_bit();
+  big_integer::magnitude l = a.get_magnitude(), r = b.get_magnitude();
+
+  // places from hi do not affect result
+  size_t an = std::min(l.size, hi), bn = std::min(r.size, hi);
+  big_integer res;
+  if (lo >= std::min(hi, an + bn))
+    return res;
+
+  // extra zero place for sign
+  size_t size = std::min(hi, an + bn) - lo;
+  big_integer::storage_t places(size + 1, 0);
+  if (lo == 0)
+    mul_low_places(places.data(), l.places, an, r.places, bn, size);
+  else
+  {
+    std::vector<uint32_t> high(an + bn - lo);
+    mul_high_places(high.data(), l.places, an, r.places, bn, lo);
+    std::copy_n(high.begin(), size, places.data());
+  }
+  res.data.swap(places);
+  return res.set_magnitude_sign(sign);
+}
+
+struct big_integer_multiplier::prepared
+{
+  big_integer factor;
+  bool sign;
+  // factor magnitude with its splits
+  fixed_operand operand;
+
+  // transforms by their log of length
+  std::mutex m;
+  std::map<int, std::shared_ptr<const ntt_operand>> transforms;
+
+  explicit prepared(const big_integer &factor) :
+    factor(factor), sign(factor.sign_bit()), operand(magnitude_of(factor))
+  {}
+
+  static signed_places magnitude_of(const big_integer &a)
+  {
+    big_integer::magnitude m = a.get_magnitude();
+    return signed_places(m.places, m.size);
+  }
+
+  std::shared_ptr<const ntt_operand> get_transform(int log, thread_pool *pool)
+  {
+    {
+      std::lock_guard<std::mutex> lock(m);
+      auto it = transforms.find(log);
+      if (it != transforms.end())
+        return it->second;
+    }
+    // computed without lock, concurrent computation of the same transform is not harmful
+    const std::vector<uint32_t> &places = operand.value.places;
+    auto transform = std::make_shared<const ntt_operand>(places.data(), places.size(), log, pool);
+    std::lock_guard<std::mutex> lock(m);
+    return transforms.emplace(log, transform).first->second;
+  }
+};
+
+big_integer_multiplier::big_integer_multiplier(const big_integer &factor) :
+  state(std::make_shared<prepared>(factor))
+{}
+
+const big_integer & big_integer_multiplier::factor() const
+{
+  return state->factor;
+}
+
+big_integer & big_integer_multiplier::multiply(big_integer &a) const
+{
+  const std::vector<uint32_t> &b = state->operand.value.places;
+  bool sign = a.sign_bit() ^ state->sign;
+  big_integer::magnitude l = a.get_magnitude();
+  size_t an = l.size, bn = b.size();
+
+  // extra zero place for sign
+  big_integer::storage_t res(an + bn + 1, 0);
+  size_t lo = std::min(an, bn), hi = std::max(an, bn);
+  if (lo != 0 && use_ntt(hi, lo))
+  {
+    std::shared_ptr<thread_pool> pool = use_parallel(hi, lo) ? get_thread_pool() : nullptr;
+    std::shared_ptr<const ntt_operand> transform = state->get_transform(ceil_log2(an + bn - 1), pool.get());
+    mul_ntt(res.data(), l.places, an, b.data(), bn, pool.get(), transform.get());
+  }
+  else if (lo != 0 && use_parallel(hi, lo))
+    mul_top(res.data(), l.places, an, b.data(), bn);
+  else
+    mul_fixed(res.data(), l.places, an, state->operand);
+  a.data.swap(res);
+  return a.set_magnitude_sign(sign);
+}
+
+struct big_integer_divisor::prepared
+{
+  big_integer divisor;
+  bool sign;
+  // normalized magnitude of divisor
+  unsigned shift = 0;
+  std::vector<uint32_t> places;
+  // reciprocal_2_1 of 1 place or reciprocal_3_2 of 2 high places
+  uint32_t inv = 0;
+  // invert_places reciprocal with m + 1 places (for at least burnikel_ziegler_threshold places)
+  std::vector<uint32_t> reciprocal;
+};
+
+big_integer_divisor::big_integer_divisor(const big_integer &divisor)
+{
+  check_divisor(divisor);
+  auto res = std::make_shared<prepared>();
+  big_integer::magnitude d = divisor.get_magnitude();
+  size_t m = d.size;
+  res->divisor = divisor;
+  res->sign = divisor.sign_bit();
+  res->places.assign(d.places, d.places + m);
+  if (m == 1)
+  {
+    res->shift = normalization_shift(d.places[0]);
+    res->places[0] <<= res->shift;
+    res->inv = reciprocal_2_1(res->places[0]);
+  }
+  else if (m >= 2)
+  {
+    res->shift = normalization_shift(d.places[m - 1]);
+    if (res->shift != 0)
+      lshift(res->places.data(), d.places, m, res->shift);
+    res->inv = reciprocal_3_2(res->places.data(), m);
+    if (m >= std::max(big_integer::tuning::burnikel_ziegler_threshold, size_t{4}))
+    {
+      res->reciprocal.resize(m + 1);
+      invert_places(res->reciprocal.data(), res->places.data(), m);
+    }
+  }
+  state = std::move(res);
+}
+
+const big_integer & big_integer_divisor::divisor() const
+{
+  return state->divisor;
+}
+
+void big_integer_divisor::divide(const big_integer &a, big_integer *quotient, big_integer *remainder) const
+{
+  const prepared &p = *state;
+  big_integer q = a, r;
+  bool a_sign = q.make_absolute(), sign = a_sign ^ p.sign;
+  size_t n = q.unsigned_size(), m = p.places.size();
+
+  if (m == 1)
+  {
+    uint32_t *places = q.data.data();
+    r = big_integer(divrem_1(places, places, q.size(), p.places[0], p.shift, p.inv));
+    q.shrink();
+  }
+  else if (m > n)
+  {
+    r = q;
+    q = 0;
+  }
+  else
+  {
+    // the same as long_divide with normalization of divisor done
+    big_integer::storage_t rs(n + 1, 0);
+    const uint32_t *places = static_cast<const big_integer::storage_t &>(q.data).data();
+    if (p.shift == 0)
+      std::copy_n(places, n, rs.data());
+    else
+      rs[n] = lshift(rs.data(), places, n, p.shift);
+
+    big_integer::storage_t qs(n - m + 2, 0);
+    if (!p.reciprocal.empty() && n - m + 1 >= big_integer::tuning::burnikel_ziegler_threshold)
+      div_newton(qs.data(), rs.data(), n, p.places.data(), m, p.reciprocal.data());
+    else
+      div_basecase(qs.data(), rs.data(), n, p.places.data(), m, p.inv);
+
+    if (p.shift != 0)
+      rshift(rs.data(), rs.data(), m, p.shift);
+    q.data.swap(qs);
+    q.shrink();
+    r.data.swap(rs);
+    r.shrink();
+  }
+  if (quotient != nullptr)
+    *quotient = std::move(q.revert_sign(sign));
+  if (remainder != nullptr)
+    *remainder = std::move(r.revert_sign(a_sign));
+}
+
+big_integer big_integer_divisor::div(const big_integer &a) const
+{
+  big_integer q;
+  divide(a, &q, nullptr);
+  return q;
+}
+
+big_integer big_integer_divisor::mod(const big_integer &a) const
+{
+  big_integer r;
+  divide(a, nullptr, &r);
+  return r;
+}
+
+std::pair<big_integer, big_integer> big_integer_divisor::divmod(const big_integer &a) const
+{
+  std::pair<big_integer, big_integer> res;
+  divide(a, &res.first, &res.second);
+  return res;
+}
+
+// division of a positive number by a positive integer that fits into place_t
+// with multiplications by reciprocal
+// (requires place_t to be uint32_t because of divrem_1)
+big_integer & big_integer::short_divide(place_t rhs, place_t &rem)
+{
+  assert(rhs != 0);
+  unsigned shift = normalization_shift(rhs);
+  rhs <<= shift;
+  place_t *places = data.data();
+  rem = divrem_1(places, places, size(), rhs, shift, reciprocal_2_1(rhs));
+  return shrink();
+}
+
+// long division of normalized magnitudes with schoolbook, recursive
+// or multiplication by reciprocal algorithms by sizes
+// (requires place_t to be uint32_t because of short_divide & place arithmetic)
+big_integer & big_integer::long_divide(const big_integer &rhs, big_integer &rem)
+{
+  check_divisor(rhs);
+  // rhs may alias *this, its sign is read before data is changed
+  bool rhs_sign = rhs.sign_bit(), this_sign = make_absolute(), sign = this_sign ^ rhs_sign;
+
+  // its magnitude is not used after data is changed
+  magnitude right = rhs.get_magnitude();
+
+  size_t n = unsigned_size(), m = right.size;
+
+  if (m == 1)
+  {
+    place_t r;
+    short_divide(right.places[0], r);
+    rem = big_integer(r);
+  }
+  else if (m > n)
+  {
+    // divisor is greater than dividend, quotient is 0, remainder is dividend
+    rem = *this;
+    *this = 0;
+  }
+  else
+  {
+    // divide with base 2^PLACE_BITS
+    // 2 <= m <= n -- true
+
+    // normalize divisor d with shift (largest place >= base / 2),
+    // starting remainder r is normalized dividend with extra high place
+    unsigned shift = normalization_shift(right.places[m - 1]);
+    storage_t r(n + 1, 0), d(m, 0);
+    const place_t *places = static_cast<const storage_t &>(data).data();
+    if (shift == 0)
+    {
+      std::copy_n(places, n, r.data());
+      std::copy_n(right.places, m, d.data());
+    }
+    else
+    {
+      r[n] = lshift(r.data(), places, n, shift);
+      lshift(d.data(), right.places, m, shift);
+    }
+
+    storage_t q(n - m + 2, 0);
+    if (m >= tuning::newton_division_threshold && n - m + 1 >= tuning::newton_division_threshold)
+      div_newton(q.data(), r.data(), n, d.data(), m);
+    else if (m >= tuning::burnikel_ziegler_threshold && n - m + 1 >= tuning::burnikel_ziegler_threshold)
+      div_dc(q.data(), r.data(), n, d.data(), m);
+    else
+      div_basecase(q.data(), r.data(), n, d.data(), m, reciprocal_3_2(d.data(), m));
+
+    // denormalize remainder, its places from m are zero
+    if (shift != 0)
+      rshift(r.data(), r.data(), m, shift);
+    data.swap(q);
+    shrink();
+    rem.data.swap(r);
+    rem.shrink();
+  }
+  rem.revert_sign(this_sign);
+  return revert_sign(sign);
+}
+
+// exact division of a positive number by a positive integer that fits into place_t
+big_integer & big_integer::short_divexact(place_t rhs)
+{
+  assert(rhs != 0);
+  divexact_1(data.data(), size(), rhs);
+  return shrink();
+}
+
+// exact division of magnitudes with Hensel's algorithm after removal of low zero bits
+big_integer & big_integer::long_divexact(const big_integer &rhs)
+{
+  check_divisor(rhs);
+  bool rhs_sign = rhs.sign_bit(), sign = make_absolute() ^ rhs_sign;
+
+  // rhs may alias *this, its magnitude is not used after data is changed
+  magnitude right = rhs.get_magnitude();
+  size_t n = unsigned_size(), m = right.size;
+
+  if (m == 1)
+  {
+    place_t d = right.places[0];
+    short_divexact(d);
+  }
+  else if (m > n)
+    // only zero is divisible by greater number
+    *this = 0;
+  else
+  {
+    // low zero places & bits of divisor are zero in dividend too
+    size_t zeros = 0;
+    while (right.places[zeros] == 0)
+      zeros++;
+    unsigned shift = 0;
+    while ((right.places[zeros] >> shift & 1) == 0)
+      shift++;
+    const place_t *places = static_cast<const storage_t &>(data).data();
+    std::vector<place_t> a(places + zeros, places + n), d(right.places + zeros, right.places + m);
+    if (shift != 0)
+    {
+      rshift(a.data(), a.data(), a.size(), shift);
+      rshift(d.data(), d.data(), d.size(), shift);
+    }
+    size_t an = normalized_size(a.data(), a.size()), dn = normalized_size(d.data(), d.size());
+
+    if (an < dn)
+      // dividend with more low zero bits is not divisible, result is unspecified as for m > n
+      *this = 0;
+    else
+    {
+      // extra zero place for sign
+      storage_t q(an - dn + 2, 0);
+      if (dn == 1)
+      {
+        std::copy_n(a.begin(), an, q.data());
+        divexact_1(q.data(), an, d[0]);
+      }
+      else
+        divexact_places(q.data(), a.data(), an, d.data(), dn);
+      data.swap(q);
+      shrink();
+    }
+  }
+  return revert_sign(sign);
+}
+
+big_integer & big_integer::operator/=(const big_integer &rhs)
+{
+  big_integer dummy;
+  return long_divide(rhs, dummy);
+}
+
+big_integer & big_integer::operator%=(const big_integer &rhs)
+{
+  big_integer(*this).long_divide(rhs, *this);
+  return *this;
+}
+
+big_integer & big_integer::operator&=(const big_integer &rhs)
+{
+  return place_wise(rhs, std::bit_and<place_t>());
+}
+
+big_integer & big_integer::operator|=(const big_integer &rhs)
+{
+  return place_wise(rhs, std::bit_or<place_t>());
+}
+
+big_integer & big_integer::operator^=(const big_integer &rhs)
+{
+  return place_wise(rhs, std::bit_xor<place_t>());
+}
+
+big_integer & big_integer::operator<<=(int rhs)
+{
+  return bit_shift(rhs);
+}
+
+big_integer & big_integer::operator>>=(int rhs)
+{
+  return bit_shift(-rhs);
+}
+
+big_integer & big_integer::bit_shift(int rhs)
+{
+  // rhs > 0 -> left shift
+  // rhs < 0 -> right shift
+
+  // [lsrc][rsrc]
+  //       <-> bits
+  //    [plce]
+  bool sign = sign_bit();
+  int places = rhs / PLACE_BITS, bits = rhs % PLACE_BITS;
+  if (rhs < 0 && bits != 0)
+    places--, bits += PLACE_BITS;
+  std::vector<place_t> new_data(std::max(data.size() + places + (bits > 0), size_t{1}),
+                                get_or_default(rhs < 0 ?
+                                  static_cast<int64_t>(data.size()) : -1));
+  for (size_t i = std::max(places, 0); i < data.size() + places + (bits > 0); i++)
+  {
+    // handle PLACE_BITS shift undefined behavior with cases
+    if (bits == 0)
+      new_data[i] = data[i - places];
+    else
+    {
+      place_t
+        lsrc = get_or_default(static_cast<int64_t>(i) - places),
+        rsrc = get_or_default(static_cast<int64_t>(i) - places - 1);
+      new_data[i] = (lsrc << bits) | (rsrc >> (PLACE_BITS - bits));
+    }
+  }
+  data = storage_t(new_data);
+  return correct_sign_bit(sign);
+}
+
+big_integer big_integer::operator+() const
+{
+  return *this;
+}
+
+big_integer big_integer::operator-() const
+{
+  return ~ *this + 1;
+}
+
+big_integer big_integer::operator~() const
+{
+  return big_integer().place_wise(*this, [](place_t x, place_t y) { return ~y; });
+}
+
+big_integer & big_integer::operator++()
+{
+  return *this += 1;
+}
+
+big_integer big_integer::operator++(int)
+{
+  big_integer r = *this;
+  ++ *this;
+  return r;
+}
+
+big_integer & big_integer::operator--()
+{
+  return *this -= 1;
+}
+
+big_integer big_integer::operator--(int)
+{
+  big_integer r = *this;
+  -- *this;
+  return r;
+}
+
+big_integer operator+(big_integer a, const big_integer &b)
 {
   return a += b;
 }
@@ -590,6 +2441,21 @@ big_integer operator*(big_integer a, const big_integer &b)
   return a *= b;
 }
 
+big_integer & operator*=(big_integer &a, const big_integer_multiplier &b)
+{
+  return b.multiply(a);
+}
+
+big_integer operator*(big_integer a, const big_integer_multiplier &b)
+{
+  return a *= b;
+}
+
+big_integer operator*(const big_integer_multiplier &a, big_integer b)
+{
+  return b *= a;
+}
+
 big_integer operator/(big_integer a, const big_integer &b)
 {
   return a /= b;
@@ -600,6 +2466,56 @@ big_integer operator%(big_integer a, const big_integer &b)
   return a %= b;
 }
 
+big_integer divexact(big_integer a, const big_integer &b)
+{
+#ifndef NDEBUG
+  big_integer dividend = a;
+#endif
+  a.long_divexact(b);
+  assert(a * b == dividend);
+  return a;
+}
+
+std::pair<big_integer, big_integer> divmod(big_integer a, const big_integer &b)
+{
+  std::pair<big_integer, big_integer> res;
+  res.first = std::move(a);
+  res.first.long_divide(b, res.second);
+  return res;
+}
+
+std::pair<big_integer, big_integer> floor_divmod(big_integer a, const big_integer &b)
+{
+  std::pair<big_integer, big_integer> res = divmod(std::move(a), b);
+  // nonzero remainder has sign of dividend, it is corrected to sign of divisor
+  if (res.second.sign() != 0 && res.second.sign_bit() != b.sign_bit())
+  {
+    --res.first;
+    res.second += b;
+  }
+  return res;
+}
+
+std::pair<big_integer, big_integer> euclid_divmod(big_integer a, const big_integer &b)
+{
+  std::pair<big_integer, big_integer> res = divmod(std::move(a), b);
+  // negative remainder is corrected to positive one
+  if (res.second.sign_bit())
+  {
+    if (b.sign_bit())
+    {
+      ++res.first;
+      res.second -= b;
+    }
+    else
+    {
+      --res.first;
+      res.second += b;
+    }
+  }
+  return res;
+}
+
 big_integer operator&(big_integer a, const big_integer &b)
 {
   return a &= b;
@@ -683,23 +2599,752 @@ bool operator>=(const big_integer &a, const big_integer &b)
   return big_integer::compare(a, b) >= 0;
 }
 
+/* Decimal conversions: chunks of 9 digits (8 ones for parsing) in places are converted
+ * with basecase algorithms, numbers of at least conversion_threshold places are split
+ * by powers 10^(8 * 2^k) */
+
+static constexpr uint32_t DECIMAL_CHUNK = 1000000000;
+static constexpr size_t DECIMAL_CHUNK_DIGITS = 9;
+static constexpr uint32_t DECIMAL_GROUP = 100000000;
+static constexpr size_t DECIMAL_GROUP_DIGITS = 8;
+
+// numbers with less places are not split between threads in parallel conversions
+static constexpr size_t CONVERSION_TASK_PLACES = 1024;
+
+// pool for parallel conversion of number of n places (null if it is converted in one thread)
+static std::shared_ptr<thread_pool> conversion_thread_pool(size_t n)
+{
+  switch (big_integer::tuning::parallel)
+  {
+  case big_integer::tuning::mode::forced:
+    return get_thread_pool();
+  case big_integer::tuning::mode::disabled:
+    return nullptr;
+  default:
+    return n >= big_integer::tuning::parallel_threshold ? get_thread_pool() : nullptr;
+  }
+}
+
+// upper bound of number of decimal digits of places[0, n) without high zero places
+static size_t decimal_length_bound(const uint32_t *places, size_t n)
+{
+  if (n == 0)
+    return 0;
+  size_t bits = std::numeric_limits<uint32_t>::digits * n - normalization_shift(places[n - 1]);
+  // 1234 / 4096 > log10(2)
+  return bits * 1234 / 4096 + 1;
+}
+
+const big_integer & big_integer::decimal_power(size_t k)
+{
+  static std::mutex m;
+  // references to elements stay valid when powers are added
+  static std::deque<big_integer> powers;
+
+  {
+    std::lock_guard<std::mutex> lock(m);
+    if (k < powers.size())
+      return powers[k];
+  }
+  // computed without lock: multiplication may run queued conversion tasks of thread pool
+  // in this thread, they may need powers too (concurrent computation of the same power is not harmful)
+  big_integer power;
+  if (k == 0)
+    power = static_cast<int>(DECIMAL_GROUP);
+  else
+  {
+    magnitude half = decimal_power(k - 1).get_magnitude();
+    power = sqr(from_magnitude(half.places, half.size));
+  }
+  std::lock_guard<std::mutex> lock(m);
+  // powers are added in order, the previous one is already there
+  if (powers.size() == k)
+    powers.push_back(std::move(power));
+  return powers[k];
+}
+
+template<typename prepared>
+prepared big_integer::prepared_decimal_power(size_t k)
+{
+  static std::mutex m;
+  static std::vector<std::unique_ptr<prepared>> powers;
+
+  {
+    std::lock_guard<std::mutex> lock(m);
+    if (k < powers.size() && powers[k] != nullptr)
+      return *powers[k];
+  }
+  // computed without lock as powers themselves,
+  // prepared object keeps its own copy of power
+  magnitude power = decimal_power(k).get_magnitude();
+  auto res = std::make_unique<prepared>(from_magnitude(power.places, power.size));
+  std::lock_guard<std::mutex> lock(m);
+  if (powers.size() <= k)
+    powers.resize(k + 1);
+  if (powers[k] == nullptr)
+    powers[k] = std::move(res);
+  return *powers[k];
+}
+
+// "00" to "99"
+static constexpr char DECIMAL_PAIRS[] =
+  "0001020304050607080910111213141516171819"
+  "2021222324252627282930313233343536373839"
+  "4041424344454647484950515253545556575859"
+  "6061626364656667686970717273747576777879"
+  "8081828384858687888990919293949596979899";
+
+// writes len low decimal digits of x before end
+static void write_decimal(char *end, uint32_t x, size_t len)
+{
+  for (; len >= 2; len -= 2)
+  {
+    end -= 2;
+    std::memcpy(end, DECIMAL_PAIRS + 2 * (x % 100), 2);
+    x /= 100;
+  }
+  if (len != 0)
+    end[-1] = static_cast<char>('0' + x % 10);
+}
+
+// number of decimal digits of x > 0
+static size_t decimal_length(uint32_t x)
+{
+  size_t len = 0;
+  for (; x != 0; x /= 10)
+    len++;
+  return len;
+}
+
+big_integer big_integer::from_magnitude(const place_t *places, size_t n)
+{
+  big_integer res;
+  storage_t data(n + 1, 0);
+  std::copy_n(places, n, data.data());
+  res.data.swap(data);
+  res.shrink();
+  return res;
+}
+
+char * big_integer::to_decimal(char *out, const place_t *places, size_t n, size_t width, thread_pool *pool)
+{
+  if (n >= std::max(tuning::conversion_threshold, size_t{2}))
+  {
+    // split by power with about half of places
+    size_t k = 0;
+    while (decimal_power(k + 1).unsigned_size() <= n / 2)
+      k++;
+    size_t low_width = DECIMAL_GROUP_DIGITS << k, high_width = width > low_width ? width - low_width : 0;
+    std::pair<big_integer, big_integer> qr =
+      prepared_decimal_power<big_integer_divisor>(k).divmod(from_magnitude(places, n));
+    magnitude high = qr.first.get_magnitude(), low = qr.second.get_magnitude();
+    if (pool != nullptr && n >= CONVERSION_TASK_PLACES && high_width >= decimal_length_bound(high.places, high.size))
+    {
+      // high digits fill their slice, so halves are written independently
+      task_group group(*pool);
+      group.run([&] { to_decimal(out, high.places, high.size, high_width, pool); });
+      char *end = to_decimal(out + high_width, low.places, low.size, low_width, pool);
+      group.wait();
+      return end;
+    }
+    out = to_decimal(out, high.places, high.size, high_width, pool);
+    return to_decimal(out, low.places, low.size, low_width, pool);
+  }
+
+  // chunks are remainders of divisions by 10^9 (from low ones),
+  // there are less than n + n / 8 + 1 of them, buffers are on stack for small numbers
+  constexpr size_t small_size = 64;
+  place_t small_places[small_size], small_chunks[small_size + small_size / 8 + 1];
+  std::vector<place_t> large_places, large_chunks;
+  place_t *dividend = small_places, *chunks = small_chunks;
+  if (n > small_size)
+  {
+    large_places.resize(n);
+    large_chunks.resize(n + n / 8 + 1);
+    dividend = large_places.data();
+    chunks = large_chunks.data();
+  }
+  std::copy_n(places, n, dividend);
+  unsigned shift = normalization_shift(DECIMAL_CHUNK);
+  uint32_t d = DECIMAL_CHUNK << shift, inv = reciprocal_2_1(d);
+  size_t count = 0;
+  while (n != 0)
+  {
+    chunks[count++] = divrem_1(dividend, dividend, n, d, shift, inv);
+    n = normalized_size(dividend, n);
+  }
+
+  size_t digits = count == 0 ? 0 : DECIMAL_CHUNK_DIGITS * (count - 1) + decimal_length(chunks[count - 1]);
+  if (width > digits)
+    out = std::fill_n(out, width - digits, '0');
+  char *end = out + digits;
+  for (size_t i = 0; i < count; i++, end -= DECIMAL_CHUNK_DIGITS)
+    write_decimal(end, chunks[i], i + 1 < count ? DECIMAL_CHUNK_DIGITS : decimal_length(chunks[i]));
+  return out + digits;
+}
+
+size_t big_integer::decimal_chunks(place_t *chunks, const char *digits, size_t n)
+{
+  return big_int_util::decimal_chunks(chunks, digits, n);
+}
+
+void big_integer::from_decimal(const place_t *chunks, size_t count)
+{
+  std::shared_ptr<thread_pool> pool = conversion_thread_pool(count);
+  from_decimal(chunks, count, pool.get());
+}
+
+void big_integer::from_decimal(const place_t *chunks, size_t count, thread_pool *pool)
+{
+  if (count >= std::max(tuning::conversion_threshold, size_t{2}))
+  {
+    // number = high * 10^(8 * 2^k) + low, low has 2^k chunks, high has not more
+    size_t k = 0;
+    while ((size_t{2} << k) < count)
+      k++;
+    size_t low_count = size_t{1} << k;
+    big_integer low;
+    if (pool != nullptr && count >= CONVERSION_TASK_PLACES)
+    {
+      task_group group(*pool);
+      group.run([&] { low.from_decimal(chunks + (count - low_count), low_count, pool); });
+      from_decimal(chunks, count - low_count, pool);
+      group.wait();
+    }
+    else
+    {
+      low.from_decimal(chunks + (count - low_count), low_count, pool);
+      from_decimal(chunks, count - low_count, pool);
+    }
+    prepared_decimal_power<big_integer_multiplier>(k).multiply(*this);
+    *this += low;
+    return;
+  }
+
+  // Horner's scheme with base 10^8, number of places is not greater than number of chunks
+  // (extra zero place for sign)
+  storage_t res(count + 1, 0);
+  place_t *places = res.data();
+  size_t n = 0;
+  for (size_t i = 0; i < count; i++)
+  {
+    place_t high = mul_1(places, places, n, DECIMAL_GROUP);
+    high += add_1(places, places, n, chunks[i]);
+    if (high != 0)
+      places[n++] = high;
+  }
+  data.swap(res);
+  shrink();
+}
+
+/* Incremental decimal parsing */
+
+// groups in block converted by basecase algorithm, 10^(8 * block_groups) is decimal_power(BLOCK_GROUPS_LOG)
+static constexpr size_t BLOCK_GROUPS_LOG = 6;
+static constexpr size_t BLOCK_GROUPS = size_t{1} << BLOCK_GROUPS_LOG;
+
+big_integer_parser::big_integer_parser()
+{
+  reset();
+}
+
+void big_integer_parser::reset()
+{
+  blocks.clear();
+  groups.clear();
+  group = 0;
+  group_digits = 0;
+  offset = 0;
+  is_negated = false;
+}
+
+size_t big_integer_parser::size() const
+{
+  return offset;
+}
+
+void big_integer_parser::feed(std::string_view chars)
+{
+  feed(chars.data(), chars.size());
+}
+
+void big_integer_parser::feed(const char *chars, size_t n)
+{
+  size_t i = 0;
+  if (offset == 0 && n != 0 && chars[0] == '-')
+  {
+    is_negated = true;
+    i++;
+  }
+  while (i < n)
+  {
+    if (group_digits == 0 && n - i >= DECIMAL_GROUP_DIGITS)
+    {
+      // whole groups up to the end of block are converted at once
+      size_t count = std::min((n - i) / DECIMAL_GROUP_DIGITS, BLOCK_GROUPS - groups.size()),
+        start = groups.size();
+      groups.resize(start + count);
+      size_t valid = decimal_chunks(groups.data() + start, chars + i, count * DECIMAL_GROUP_DIGITS);
+      if (valid != count * DECIMAL_GROUP_DIGITS)
+        throw std::runtime_error("Cannot read number, invalid character at offset " +
+                                 std::to_string(offset + i + valid));
+      i += count * DECIMAL_GROUP_DIGITS;
+      if (groups.size() == BLOCK_GROUPS)
+        push_block();
+      continue;
+    }
+
+    unsigned digit = big_integer::digit_value(chars[i]);
+    if (digit > 9)
+      throw std::runtime_error("Cannot read number, invalid character at offset " + std::to_string(offset + i));
+    group = group * 10 + digit;
+    i++;
+    if (++group_digits == DECIMAL_GROUP_DIGITS)
+    {
+      push_group(group);
+      group = 0;
+      group_digits = 0;
+    }
+  }
+  offset += n;
+}
+
+void big_integer_parser::push_group(uint32_t value)
+{
+  groups.push_back(value);
+  if (groups.size() == BLOCK_GROUPS)
+    push_block();
+}
+
+void big_integer_parser::push_block()
+{
+  big_integer value;
+  value.from_decimal(groups.data(), groups.size());
+  groups.clear();
+  blocks.emplace_back(std::move(value), 0);
+
+  // high * 10^(8 * block_groups * 2^k) + low, as in binary counter
+  while (blocks.size() >= 2 && blocks[blocks.size() - 2].second == blocks.back().second)
+  {
+    std::pair<big_integer, size_t> low = std::move(blocks.back());
+    blocks.pop_back();
+    big_integer &high = blocks.back().first;
+    big_integer::prepared_decimal_power<big_integer_multiplier>(BLOCK_GROUPS_LOG + low.second).multiply(high);
+    high += low.first;
+    blocks.back().second++;
+  }
+}
+
+big_integer big_integer_parser::finish()
+{
+  if (blocks.empty() && groups.empty() && group_digits == 0)
+    throw std::runtime_error("Cannot read number, no digits");
+
+  // blocks are combined from high ones
+  big_integer res;
+  for (std::pair<big_integer, size_t> &block : blocks)
+  {
+    big_integer::prepared_decimal_power<big_integer_multiplier>(BLOCK_GROUPS_LOG + block.second).multiply(res);
+    res += block.first;
+  }
+
+  // res * 10^(8 * groups + group_digits) + groups * 10^group_digits + group
+  big_integer tail, power = 1;
+  tail.from_decimal(groups.data(), groups.size());
+  for (size_t k = 0; (groups.size() >> k) != 0; k++)
+    if (((groups.size() >> k) & 1) != 0)
+      power *= big_integer::decimal_power(k);
+  int digits_power = 1;
+  for (size_t i = 0; i < group_digits; i++)
+    digits_power *= 10;
+  tail *= digits_power;
+  tail += static_cast<int>(group);
+  power *= digits_power;
+  res *= power;
+  res += tail;
+
+  if (is_negated)
+    res = -res;
+  reset();
+  return res;
+}
+
+std::istream & operator>>(std::istream &s, big_integer &a)
+{
+  std::istream::sentry sentry(s);
+  if (!sentry)
+    return s;
+
+  // chars are read from stream buffer to stop before first non-digit
+  using traits = std::istream::traits_type;
+  std::streambuf *buf = s.rdbuf();
+  big_integer_parser parser;
+  char chunk[4096];
+  size_t n = 0;
+  bool has_digits = false;
+  traits::int_type c = buf->sgetc();
+  if (traits::eq_int_type(c, traits::to_int_type('-')))
+  {
+    chunk[n++] = '-';
+    c = buf->snextc();
+  }
+  for (; !traits::eq_int_type(c, traits::eof()) && traits::to_char_type(c) >= '0' && traits::to_char_type(c) <= '9';
+       c = buf->snextc())
+  {
+    has_digits = true;
+    chunk[n++] = traits::to_char_type(c);
+    if (n == sizeof(chunk))
+    {
+      parser.feed(chunk, n);
+      n = 0;
+    }
+  }
+  parser.feed(chunk, n);
+
+  std::ios_base::iostate state = std::ios_base::goodbit;
+  if (traits::eq_int_type(c, traits::eof()))
+    state |= std::ios_base::eofbit;
+  if (has_digits)
+    a = parser.finish();
+  else
+    state |= std::ios_base::failbit;
+  s.setstate(state);
+  return s;
+}
+
+/* Conversions in other bases: powers of 2 are converted by bit fields of places,
+ * others -- with basecase algorithms by chunks of digits */
+
+static constexpr char DIGITS[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+
+// bits per digit for power of 2 base, 0 for others
+static unsigned digit_bits(int base)
+{
+  unsigned bits = 0;
+  while ((1 << bits) < base)
+    bits++;
+  return (1 << bits) == base ? bits : 0;
+}
+
+// chunk_base = base^digits with as many digits as fit into place
+static void digit_chunk(int base, uint32_t &chunk_base, size_t &digits)
+{
+  chunk_base = static_cast<uint32_t>(base);
+  digits = 1;
+  while (uint64_t{chunk_base} * base <= std::numeric_limits<uint32_t>::max())
+  {
+    chunk_base *= base;
+    digits++;
+  }
+}
+
+void big_integer::from_digits(const uint8_t *values, size_t n, int base)
+{
+  // number of places is not greater than n * log2(36) / 32 + 1 (extra zero place for sign)
+  storage_t res(n * 6 / PLACE_BITS + 2, 0);
+  place_t *places = res.data();
+  if (unsigned bits = digit_bits(base))
+  {
+    // digits are bit fields of places from low ones
+    size_t at = 0;
+    for (size_t i = n; i-- > 0; at += bits)
+    {
+      uint64_t field = uint64_t{values[i]} << (at % PLACE_BITS);
+      places[at / PLACE_BITS] |= low_bytes(field);
+      if (high_bytes(field) != 0)
+        places[at / PLACE_BITS + 1] |= high_bytes(field);
+    }
+  }
+  else
+  {
+    // Horner's scheme with chunks of digits (the first one may be shorter)
+    uint32_t chunk_base;
+    size_t chunk_digits, size = 0;
+    digit_chunk(base, chunk_base, chunk_digits);
+    for (size_t i = 0, len = (n - 1) % chunk_digits + 1; i < n; i += len, len = chunk_digits)
+    {
+      place_t chunk = 0;
+      for (size_t j = 0; j < len; j++)
+        chunk = chunk * base + values[i + j];
+      place_t high = mul_1(places, places, size, chunk_base);
+      high += add_1(places, places, size, chunk);
+      if (high != 0)
+        places[size++] = high;
+    }
+  }
+  data.swap(res);
+  shrink();
+}
+
+// writes digits of places[0, n) in base 2^bits, returns end
+static char * to_digits_pow2(char *out, const uint32_t *places, size_t n, unsigned bits)
+{
+  size_t total_bits = std::numeric_limits<uint32_t>::digits * n - normalization_shift(places[n - 1]);
+  size_t digits = (total_bits + bits - 1) / bits, at = 0;
+  char *end = out + digits;
+  for (size_t i = 0; i < digits; i++, at += bits)
+  {
+    size_t place = at / std::numeric_limits<uint32_t>::digits;
+    uint64_t window = places[place];
+    if (place + 1 < n)
+      window |= uint64_t{places[place + 1]} << std::numeric_limits<uint32_t>::digits;
+    *--end = DIGITS[(window >> (at % std::numeric_limits<uint32_t>::digits)) & ((1u << bits) - 1)];
+  }
+  return out + digits;
+}
+
+// writes digits of places[0, n) in other base, returns end
+static char * to_digits(char *out, const uint32_t *places, size_t n, int base)
+{
+  // chunks are remainders of divisions by base^k > 2^26 (from low ones),
+  // there are less than n + n / 4 + 1 of them, buffers are on stack for small numbers
+  uint32_t chunk_base;
+  size_t chunk_digits;
+  digit_chunk(base, chunk_base, chunk_digits);
+  constexpr size_t small_size = 64;
+  uint32_t small_places[small_size], small_chunks[small_size + small_size / 4 + 1];
+  std::vector<uint32_t> large_places, large_chunks;
+  uint32_t *dividend = small_places, *chunks = small_chunks;
+  if (n > small_size)
+  {
+    large_places.resize(n);
+    large_chunks.resize(n + n / 4 + 1);
+    dividend = large_places.data();
+    chunks = large_chunks.data();
+  }
+  std::copy_n(places, n, dividend);
+  unsigned shift = normalization_shift(chunk_base);
+  uint32_t d = chunk_base << shift, inv = reciprocal_2_1(d);
+  size_t count = 0;
+  while (n != 0)
+  {
+    chunks[count++] = divrem_1(dividend, dividend, n, d, shift, inv);
+    n = normalized_size(dividend, n);
+  }
+  for (size_t i = count; i-- > 0;)
+  {
+    char digits[std::numeric_limits<uint32_t>::digits];
+    size_t len = 0;
+    for (uint32_t chunk = chunks[i]; chunk != 0 || (i + 1 < count && len < chunk_digits); chunk /= base)
+      digits[len++] = DIGITS[chunk % base];
+    out = std::reverse_copy(digits, digits + len, out);
+  }
+  return out;
+}
+
+static void check_base(int base)
+{
+  if (base < 2 || base > 36)
+    throw std::invalid_argument("Base must be from 2 to 36: " + std::to_string(base));
+}
+
+size_t to_chars_size(const big_integer &a, int base)
+{
+  check_base(base);
+  // bit length of magnitude of negative number is not greater than one of its complement plus 1
+  bool sign = a.sign_bit();
+  uint32_t top = sign ? ~a.data.back() : a.data.back();
+  size_t bits = big_integer::PLACE_BITS * (a.data.size() - 1) + sign;
+  if (top != 0)
+    bits += big_integer::PLACE_BITS - normalization_shift(top);
+
+  // number below 2^bits has at most floor(bits * log(2) / log(base)) + 1 digits
+  size_t digits;
+  if (unsigned digit_bits_count = digit_bits(base))
+    digits = (bits + digit_bits_count - 1) / digit_bits_count;
+  else if (base == 10)
+    // 1234 / 4096 > log10(2)
+    digits = bits * 1234 / 4096 + 1;
+  else
+    digits = static_cast<size_t>(bits / std::log2(base)) + 2;
+  return sign + std::max(digits, size_t{1});
+}
+
+std::to_chars_result to_chars(char *first, char *last, const big_integer &a, int base)
+{
+  size_t bound = to_chars_size(a, base);
+  if (static_cast<size_t>(last - first) < bound)
+  {
+    // exact size is not known, digits are written to temporary buffer
+    std::string digits = to_string(a, base);
+    if (digits.size() > static_cast<size_t>(last - first))
+      return {last, std::errc::value_too_large};
+    return {std::copy(digits.begin(), digits.end(), first), std::errc()};
+  }
+
+  // magnitude is copied to stack for small negative numbers
+  constexpr size_t small_size = 64;
+  uint32_t small_places[small_size];
+  std::vector<uint32_t> large_places;
+  size_t size = a.data.size();
+  const uint32_t *places = static_cast<const big_integer::storage_t &>(a.data).data();
+  if (a.sign_bit())
+  {
+    uint32_t *copy = small_places;
+    if (size > small_size)
+    {
+      large_places.resize(size);
+      copy = large_places.data();
+    }
+    std::copy_n(places, size, copy);
+    negate_n(copy, size);
+    places = copy;
+    *first++ = '-';
+  }
+  size_t n = normalized_size(places, size);
+
+  if (n == 0)
+    *first++ = '0';
+  else if (base == 10)
+  {
+    if (std::shared_ptr<thread_pool> pool = conversion_thread_pool(n))
+    {
+      // digits are padded with zeros to their bound for slices of halves to be known in advance,
+      // then padding is removed
+      size_t width = decimal_length_bound(places, n);
+      char *end = big_integer::to_decimal(first, places, n, width, pool.get());
+      size_t zeros = static_cast<size_t>(std::find_if(first, end, [](char c) { return c != '0'; }) - first);
+      size_t digits = static_cast<size_t>(end - first) - zeros;
+      // ranges overlap
+      std::memmove(first, first + zeros, digits);
+      first += digits;
+    }
+    else
+      first = big_integer::to_decimal(first, places, n, 0);
+  }
+  else if (unsigned bits = digit_bits(base))
+    first = to_digits_pow2(first, places, n, bits);
+  else
+    first = to_digits(first, places, n, base);
+  return {first, std::errc()};
+}
+
+std::from_chars_result from_chars(const char *first, const char *last, big_integer &a, int base)
+{
+  check_base(base);
+  const char *it = first;
+  if (it != last && *it == '-')
+    it++;
+  const char *digits = it;
+  while (it != last && big_integer::digit_value(*it) < static_cast<unsigned>(base))
+    it++;
+  if (it == digits)
+    return {first, std::errc::invalid_argument};
+  a = big_integer(first, it, base);
+  return {it, std::errc()};
+}
+
+std::string to_string(const big_integer &a, int base)
+{
+  std::string res(to_chars_size(a, base), '\0');
+  res.resize(static_cast<size_t>(to_chars(&res[0], &res[0] + res.size(), a, base).ptr - res.data()));
+  return res;
+}
+
 std::string to_string(const big_integer &a)
 {
-  big_integer c = a;
-  bool sgn = c.make_absolute();
-  std::string reverse;
-  if (c == 0)
-    reverse.push_back('0');
-  while (c != 0)
+  return to_string(a, 10);
+}
+
+/* Binary serialization */
+
+static size_t varint_size(uint64_t x)
+{
+  size_t size = 1;
+  for (; x >= 0x80; x >>= 7)
+    size++;
+  return size;
+}
+
+static uint8_t * write_varint(uint8_t *out, uint64_t x)
+{
+  for (; x >= 0x80; x >>= 7)
+    *out++ = static_cast<uint8_t>(x | 0x80);
+  *out++ = static_cast<uint8_t>(x);
+  return out;
+}
+
+// reads varint from [first, last), returns end of it or nullptr if it is truncated or too long
+static const uint8_t * read_varint(const uint8_t *first, const uint8_t *last, uint64_t &x)
+{
+  x = 0;
+  for (unsigned shift = 0; first != last && shift < 64; shift += 7)
+  {
+    uint8_t byte = *first++;
+    x |= uint64_t{byte & 0x7Fu} << shift;
+    if ((byte & 0x80) == 0)
+      return first;
+  }
+  return nullptr;
+}
+
+// header varint: 2 * zigzag(value) for one place, 2 * size + 1 for others
+static uint64_t serialized_header(const uint32_t *places, size_t size)
+{
+  if (size == 1)
+  {
+    uint32_t zigzag = (places[0] << 1) ^ (0 - (places[0] >> 31));
+    return uint64_t{zigzag} << 1;
+  }
+  return (uint64_t{size} << 1) | 1;
+}
+
+size_t serialized_size(const big_integer &a)
+{
+  const uint32_t *places = static_cast<const big_integer::storage_t &>(a.data).data();
+  size_t size = a.data.size();
+  return varint_size(serialized_header(places, size)) + (size == 1 ? 0 : sizeof(uint32_t) * size);
+}
+
+uint8_t * serialize(uint8_t *out, const big_integer &a)
+{
+  const uint32_t *places = static_cast<const big_integer::storage_t &>(a.data).data();
+  size_t size = a.data.size();
+  out = write_varint(out, serialized_header(places, size));
+  if (size != 1)
+    for (size_t i = 0; i < size; i++)
+      for (unsigned byte = 0; byte < sizeof(uint32_t); byte++)
+        *out++ = static_cast<uint8_t>(places[i] >> (8 * byte));
+  return out;
+}
+
+std::vector<uint8_t> serialize(const big_integer &a)
+{
+  std::vector<uint8_t> res(serialized_size(a));
+  serialize(res.data(), a);
+  return res;
+}
+
+const uint8_t * deserialize(const uint8_t *first, const uint8_t *last, big_integer &a)
+{
+  uint64_t header;
+  const uint8_t *it = read_varint(first, last, header);
+  if (it == nullptr)
+    throw std::runtime_error("Cannot deserialize number: truncated or too long header");
+
+  if ((header & 1) == 0)
   {
-    uint32_t rem;
-    c.short_divide(10, rem);
-    reverse += static_cast<char>((static_cast<char>(rem) + '0'));
+    if ((header >> 1) > std::numeric_limits<uint32_t>::max())
+      throw std::runtime_error("Cannot deserialize number: one place value is out of range");
+    uint32_t zigzag = static_cast<uint32_t>(header >> 1);
+    a = big_integer(static_cast<int>((zigzag >> 1) ^ (0 - (zigzag & 1))));
+    return it;
   }
-  if (sgn)
-    reverse.push_back('-');
 
-  return std::string(reverse.rbegin(), reverse.rend());
+  uint64_t size = header >> 1;
+  if (size < 2 || size > static_cast<uint64_t>(last - it) / sizeof(uint32_t))
+    throw std::runtime_error("Cannot deserialize number: " + std::to_string(size) +
+                             " places do not fit in " + std::to_string(last - it) + " bytes");
+  big_integer res;
+  big_integer::storage_t data(static_cast<size_t>(size), 0);
+  uint32_t *places = data.data();
+  for (size_t i = 0; i < size; i++, it += sizeof(uint32_t))
+    places[i] = uint32_t{it[0]} | (uint32_t{it[1]} << 8) | (uint32_t{it[2]} << 16) | (uint32_t{it[3]} << 24);
+  res.data.swap(data);
+  // data written by other code may have redundant sign places
+  res.shrink();
+  a.data.swap(res.data);
+  return it;
 }
 
 std::ostream & operator<<(std::ostream &s, const big_integer &a)
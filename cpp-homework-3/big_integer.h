@@ -8,10 +8,23 @@
 #include <cstdint>
 #include <vector>
 #include <string>
+#include <string_view>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <charconv>
+#include <system_error>
 #include <functional>
+#include <memory>
+#include <utility>
 
 #include "optimized_buffer.h"
 
+namespace big_int_util
+{
+  class thread_pool;
+}
+
 struct big_integer
 {
 /* all public functions provide weak exception guarantee (invariant holds) */
@@ -31,7 +44,12 @@ public:
   big_integer();
   big_integer(const big_integer &other) = default;
   big_integer(int a);
-  explicit big_integer(std::string const &str);
+  // from digits with optional '-', bases are from 2 to 36 (letters of any case are digits from 10)
+  explicit big_integer(std::string_view str, int base = 10);
+  // from digits in [first, last) (forward iterators to chars)
+  template<typename ForwardIt, typename = std::enable_if_t<
+    std::is_same_v<typename std::iterator_traits<ForwardIt>::value_type, char>>>
+  explicit big_integer(ForwardIt first, ForwardIt last, int base = 10);
   ~big_integer();
 
   big_integer & operator=(const big_integer &other);
@@ -66,29 +84,134 @@ public:
   friend bool operator<=(const big_integer &a, const big_integer &b);
   friend bool operator>=(const big_integer &a, const big_integer &b);
 
+  friend big_integer sqr(const big_integer &a);
+  friend big_integer divexact(big_integer a, const big_integer &b);
+  friend std::pair<big_integer, big_integer> divmod(big_integer a, const big_integer &b);
+  friend std::pair<big_integer, big_integer> floor_divmod(big_integer a, const big_integer &b);
+  friend std::pair<big_integer, big_integer> euclid_divmod(big_integer a, const big_integer &b);
+  friend big_integer mul_middle(const big_integer &a, const big_integer &b, size_t lo, size_t hi);
   friend std::string to_string(const big_integer &a);
+  friend std::string to_string(const big_integer &a, int base);
+  friend size_t to_chars_size(const big_integer &a, int base);
+  friend std::to_chars_result to_chars(char *first, char *last, const big_integer &a, int base);
+  friend std::from_chars_result from_chars(const char *first, const char *last, big_integer &a, int base);
+  friend size_t serialized_size(const big_integer &a);
+  friend uint8_t * serialize(uint8_t *out, const big_integer &a);
+  friend const uint8_t * deserialize(const uint8_t *first, const uint8_t *last, big_integer &a);
+  friend struct big_integer_multiplier;
+  friend struct big_integer_divisor;
+  friend struct big_integer_parser;
+
+  /* Algorithm selection parameters (sizes are in places), may be changed for benchmarking */
+  struct tuning
+  {
+    // usage of optional algorithm
+    enum class mode
+    {
+      automatic, // by thresholds
+      forced,
+      disabled
+    };
+
+    // operands with less places are multiplied with basecase algorithm
+    static size_t karatsuba_threshold;
+    // numbers with less places are squared with basecase algorithm
+    static size_t sqr_karatsuba_threshold;
+    // operands with less places are multiplied with Karatsuba algorithm
+    static size_t toom3_threshold;
+    // operands with less places are multiplied with Toom-3 algorithm
+    static size_t toom4_threshold;
+    // operands with less places are multiplied with Toom-Cook algorithms
+    static size_t ntt_threshold;
+    // divisors or quotients with less places are divided with schoolbook algorithm
+    static size_t burnikel_ziegler_threshold;
+    // divisors or quotients with less places are divided with Burnikel-Ziegler algorithm,
+    // others -- with multiplication by Newton's reciprocal
+    static size_t newton_division_threshold;
+    // numbers with less places are converted to & from decimal strings with basecase algorithms,
+    // others -- with division & multiplication by powers of 10
+    static size_t conversion_threshold;
+    // number-theoretic transform multiplication usage
+    // (for products of up to 2^25 places, others fall back to Toom-Cook)
+    static mode ntt;
+    // multiplication & decimal conversions in several threads usage
+    // (for products & numbers of at least parallel_threshold places),
+    // result does not depend on number of threads
+    static mode parallel;
+    static size_t parallel_threshold;
+    // number of threads for parallel algorithms including calling one (0 -- hardware concurrency)
+    static size_t threads;
+  };
 
 private:
   explicit big_integer(place_t place);
 
+  // absolute value as places span without high zero places
+  // (copied only for negative numbers)
+  struct magnitude
+  {
+    std::vector<place_t> storage;
+    const place_t *places;
+    size_t size;
+  };
+
   /* Operators */
   big_integer & short_multiply(place_t rhs);
+  big_integer & square();
   big_integer & long_divide(const big_integer &rhs, big_integer &rem);
   big_integer & short_divide(place_t rhs, place_t &rem);
+  big_integer & long_divexact(const big_integer &rhs);
+  big_integer & short_divexact(place_t rhs);
   big_integer & bit_shift(int bits);
   static int compare(const big_integer &l, const big_integer &r);
 
+  /* Conversions */
+  // number with magnitude places[0, n) without high zero places
+  static big_integer from_magnitude(const place_t *places, size_t n);
+  // 10^(8 * 2^k), computed once per process (cached numbers are not copied:
+  // copies would share their data & its reference counter between threads)
+  static const big_integer & decimal_power(size_t k);
+  // divisors & multipliers by decimal_power(k), prepared once per process when needed
+  template<typename prepared>
+  static prepared prepared_decimal_power(size_t k);
+  // writes decimal digits of places[0, n) without high zero places padded with zeros to width,
+  // returns end of digits, halves of large numbers are converted concurrently if pool is given
+  static char * to_decimal(char *out, const place_t *places, size_t n, size_t width,
+                           big_int_util::thread_pool *pool = nullptr);
+  // values of 8-digit groups from high ones, returns offset of first non-digit or n
+  static size_t decimal_chunks(place_t *chunks, const char *digits, size_t n);
+  // from values of 8-digit groups (from high ones), in several threads for large numbers
+  void from_decimal(const place_t *chunks, size_t count);
+  void from_decimal(const place_t *chunks, size_t count, big_int_util::thread_pool *pool);
+  // from values of digits (from high ones) in other bases
+  void from_digits(const uint8_t *values, size_t n, int base);
+  // value of digit in bases up to 36 (36 for other chars)
+  static constexpr unsigned digit_value(char c)
+  {
+    unsigned code = static_cast<unsigned char>(c);
+    if (code - '0' < 10)
+      return code - '0';
+    // to lower case
+    code |= 0x20;
+    if (code - 'a' < 26)
+      return code - 'a' + 10;
+    return 36;
+  }
+
   /* Invariant-changing functions */
   // corrects sign & invariant
   big_integer & correct_sign_bit(bool expected_sign_bit, place_t carry = 0);
   // corrects invariant
   big_integer & shrink();
+  // corrects invariant of magnitude with zero high place, negating it if sign is set
+  big_integer & set_magnitude_sign(bool sign);
   // destroys invariant, inflating data
   void resize(size_t new_size);
 
   /* Non-invariant-changing function */
   bool make_absolute();
   big_integer & revert_sign(bool sign);
+  magnitude get_magnitude() const;
 
   int sign() const;
   bool sign_bit() const;
@@ -112,19 +235,197 @@ private:
     const binary_operator &action);
 };
 
+template<typename ForwardIt, typename>
+big_integer::big_integer(ForwardIt first, ForwardIt last, int base) : big_integer()
+{
+  if (base < 2 || base > 36)
+    throw std::invalid_argument("Base must be from 2 to 36: " + std::to_string(base));
+
+  auto it = first;
+  bool is_negated = false;
+  if (it != last && *it == '-')
+  {
+    is_negated = true;
+    it++;
+  }
+
+  size_t length = static_cast<size_t>(std::distance(it, last));
+  if (length == 0)
+    throw std::runtime_error("Cannot read number from string: '" + std::string(first, last) + "'");
+
+  // decimal digits are read by values of groups of 8 digits from high ones (the first one may be shorter),
+  // others -- by values of digits
+  constexpr size_t group_digits = 8;
+  std::vector<place_t> chunks;
+  std::vector<uint8_t> values;
+  size_t valid = 0;
+  if (base != 10)
+  {
+    values.resize(length);
+    for (; valid < length; valid++, it++)
+    {
+      unsigned value = digit_value(*it);
+      if (value >= static_cast<unsigned>(base))
+        break;
+      values[valid] = static_cast<uint8_t>(value);
+    }
+  }
+  else if constexpr (std::is_convertible_v<ForwardIt, const char *>)
+  {
+    // contiguous digits are converted with vector instructions
+    chunks.resize((length + group_digits - 1) / group_digits);
+    valid = decimal_chunks(chunks.data(), it, length);
+  }
+  else
+  {
+    chunks.resize((length + group_digits - 1) / group_digits);
+    for (size_t group_length = length - (chunks.size() - 1) * group_digits, i = 0; i < chunks.size(); i++)
+    {
+      size_t j = 0;
+      for (; j < group_length; j++, it++)
+      {
+        unsigned digit = digit_value(*it);
+        if (digit > 9)
+          break;
+        chunks[i] = chunks[i] * 10 + digit;
+      }
+      valid += j;
+      if (j != group_length)
+        break;
+      group_length = group_digits;
+    }
+  }
+  if (valid != length)
+    throw std::runtime_error("Cannot read number from string: '" + std::string(first, last) +
+                             "', invalid character at offset " + std::to_string(valid + is_negated));
+
+  if (base == 10)
+    from_decimal(chunks.data(), chunks.size());
+  else
+    from_digits(values.data(), length, base);
+  revert_sign(is_negated);
+}
+
+/* Multiplier by fixed factor for many products with it:
+ * factor magnitude is normalized once, its number-theoretic transforms are computed
+ * once for each transform length & its Karatsuba & Toom-Cook evaluations and chunks
+ * of unbalanced products (with those of their parts) once for a few split sizes,
+ * copies share them, usage from several threads is safe */
+struct big_integer_multiplier
+{
+  explicit big_integer_multiplier(const big_integer &factor);
+
+  const big_integer & factor() const;
+
+  // a *= factor
+  big_integer & multiply(big_integer &a) const;
+
+private:
+  struct prepared;
+  std::shared_ptr<prepared> state;
+};
+
+/* Divisor for many divisions by it (truncating as operators / & %, zero divisor throws std::domain_error):
+ * divisor magnitude is normalized once & its reciprocal is precomputed,
+ * copies share them, usage from several threads is safe */
+struct big_integer_divisor
+{
+  explicit big_integer_divisor(const big_integer &divisor);
+
+  const big_integer & divisor() const;
+
+  // a / divisor
+  big_integer div(const big_integer &a) const;
+  // a % divisor
+  big_integer mod(const big_integer &a) const;
+  // {a / divisor, a % divisor}
+  std::pair<big_integer, big_integer> divmod(const big_integer &a) const;
+
+private:
+  struct prepared;
+  std::shared_ptr<const prepared> state;
+
+  // quotient & remainder are computed if not null
+  void divide(const big_integer &a, big_integer *quotient, big_integer *remainder) const;
+};
+
+/* Incremental parser of decimal number fed by chunks of chars (e.g. as they are read from file),
+ * the whole text is not stored: blocks of digits are converted as soon as they are complete
+ * & blocks of equal lengths are combined with multiplication by cached powers of 10
+ * (as in divide & conquer parsing) */
+struct big_integer_parser
+{
+  big_integer_parser();
+
+  // reads next chars of number (optional '-' & decimal digits),
+  // throws std::runtime_error on invalid character (parser must be reset then)
+  void feed(const char *chars, size_t n);
+  void feed(std::string_view chars);
+
+  // number of read chars
+  size_t size() const;
+
+  // parsed number, parser is reset, throws std::runtime_error if no digits were read
+  big_integer finish();
+  void reset();
+
+private:
+  // complete blocks {value, k} of block_groups * 2^k groups of 8 digits from high ones (k decreases)
+  std::vector<std::pair<big_integer, size_t>> blocks;
+  // complete groups of current block
+  std::vector<uint32_t> groups;
+  // incomplete group
+  uint32_t group;
+  size_t group_digits;
+  size_t offset;
+  bool is_negated;
+
+  void push_group(uint32_t value);
+  void push_block();
+};
+
 big_integer operator+(big_integer a, const big_integer &b);
 big_integer operator-(big_integer a, const big_integer &b);
 big_integer operator*(big_integer a, const big_integer &b);
+// division by zero throws std::domain_error
 big_integer operator/(big_integer a, const big_integer &b);
 big_integer operator%(big_integer a, const big_integer &b);
 
+// a / b for a divisible by b (faster than operator /), result is unspecified for other a
+// (checked in debug build)
+big_integer divexact(big_integer a, const big_integer &b);
+
+/* Quotient & remainder {q, r} of a / b with one division, a = q * b + r */
+// truncating as operators / & %: r has sign of a
+std::pair<big_integer, big_integer> divmod(big_integer a, const big_integer &b);
+// rounding quotient down: r has sign of b
+std::pair<big_integer, big_integer> floor_divmod(big_integer a, const big_integer &b);
+// Euclidean: 0 <= r < |b|
+std::pair<big_integer, big_integer> euclid_divmod(big_integer a, const big_integer &b);
+
 big_integer operator&(big_integer a, const big_integer &b);
 big_integer operator|(big_integer a, const big_integer &b);
 big_integer operator^(big_integer a, const big_integer &b);
 
+big_integer & operator*=(big_integer &a, const big_integer_multiplier &b);
+big_integer operator*(big_integer a, const big_integer_multiplier &b);
+big_integer operator*(const big_integer_multiplier &a, big_integer b);
+
 big_integer operator<<(big_integer a, int b);
 big_integer operator>>(big_integer a, int b);
 
+// a * a with dedicated squaring algorithms
+big_integer sqr(const big_integer &a);
+
+/* Short products: parts of |a * b| by places (2^32 digits) with sign of a * b,
+ * products of digits which do not affect result are skipped */
+// low n places, same as a * b % 2^(32n)
+big_integer mul_low(const big_integer &a, const big_integer &b, size_t n);
+// all places except low n ones, same as a * b / 2^(32n)
+big_integer mul_high(const big_integer &a, const big_integer &b, size_t n);
+// places [lo, hi), same as a * b / 2^(32lo) % 2^(32(hi - lo))
+big_integer mul_middle(const big_integer &a, const big_integer &b, size_t lo, size_t hi);
+
 bool operator==(const big_integer &a, const big_integer &b);
 bool operator!=(const big_integer &a, const big_integer &b);
 bool operator<(const big_integer &a, const big_integer &b);
@@ -133,6 +434,35 @@ bool operator<=(const big_integer &a, const big_integer &b);
 bool operator>=(const big_integer &a, const big_integer &b);
 
 std::string to_string(const big_integer &a);
+// digits in base from 2 to 36 (lower case letters are digits from 10) with '-' for negative numbers,
+// conversion is linear for powers of 2
+std::string to_string(const big_integer &a, int base);
+
+/* Conversions with caller's buffers as std::to_chars & std::from_chars */
+// upper bound of number of chars written by to_chars (from bit length)
+size_t to_chars_size(const big_integer &a, int base = 10);
+// writes the same chars as to_string, returns {last, value_too_large} if chars do not fit,
+// nothing is allocated in buffers of to_chars_size chars for numbers of at most 64 places
+// (less than tuning::conversion_threshold ones in base 10)
+std::to_chars_result to_chars(char *first, char *last, const big_integer &a, int base = 10);
+// reads longest prefix of [first, last) with optional '-' & digits into a,
+// returns {first, invalid_argument} if there are no digits (a is not changed)
+std::from_chars_result from_chars(const char *first, const char *last, big_integer &a, int base = 10);
+
+/* Binary serialization: numbers of one place are LEB128 varints of 2 * zigzag(value),
+ * others -- varints of 2 * places + 1 followed by little-endian places of 2's complement form */
+// number of bytes written by serialize
+size_t serialized_size(const big_integer &a);
+// writes serialized_size(a) bytes to out, returns end of them
+uint8_t * serialize(uint8_t *out, const big_integer &a);
+std::vector<uint8_t> serialize(const big_integer &a);
+// reads one number from the beginning of [first, last) into a, returns end of its bytes,
+// throws std::runtime_error on truncated or malformed data (a is not changed)
+const uint8_t * deserialize(const uint8_t *first, const uint8_t *last, big_integer &a);
+
 std::ostream & operator<<(std::ostream &s, const big_integer &a);
+// reads optional '-' & decimal digits after whitespaces as operator >> for integers,
+// digits are parsed incrementally without storing the text
+std::istream & operator>>(std::istream &s, big_integer &a);
 
 #endif // BIG_INTEGER_H
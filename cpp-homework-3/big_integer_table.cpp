@@ -0,0 +1,193 @@
+/* Nikolai Kholiavin, M3138 */
+
+#include <cstring>
+#include <ostream>
+#include <stdexcept>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "big_integer_table.h"
+
+static constexpr char TABLE_MAGIC[8] = {'B', 'I', 'G', 'I', 'N', 'T', 'B', 'L'};
+static constexpr size_t TABLE_HEADER_SIZE = sizeof(TABLE_MAGIC) + sizeof(uint64_t);
+
+static void write_uint64(std::ostream &out, uint64_t x)
+{
+  char bytes[sizeof(uint64_t)];
+  for (unsigned i = 0; i < sizeof(uint64_t); i++)
+    bytes[i] = static_cast<char>(x >> (8 * i));
+  out.write(bytes, sizeof(bytes));
+}
+
+void big_integer_table::write(std::ostream &out, const big_integer *values, size_t n)
+{
+  out.write(TABLE_MAGIC, sizeof(TABLE_MAGIC));
+  write_uint64(out, n);
+  uint64_t offset = TABLE_HEADER_SIZE + sizeof(uint64_t) * (n + 1);
+  for (size_t i = 0; i < n; i++)
+  {
+    write_uint64(out, offset);
+    offset += serialized_size(values[i]);
+  }
+  write_uint64(out, offset);
+
+  std::vector<uint8_t> entry;
+  for (size_t i = 0; i < n; i++)
+  {
+    entry.resize(serialized_size(values[i]));
+    serialize(entry.data(), values[i]);
+    out.write(reinterpret_cast<const char *>(entry.data()), static_cast<std::streamsize>(entry.size()));
+  }
+}
+
+void big_integer_table::write(std::ostream &out, const std::vector<big_integer> &values)
+{
+  write(out, values.data(), values.size());
+}
+
+/* Read-only file mapping */
+struct big_integer_table::mapping
+{
+  const uint8_t *bytes = nullptr;
+  size_t length = 0;
+#ifdef _WIN32
+  HANDLE file = INVALID_HANDLE_VALUE, map = nullptr;
+#endif
+
+  explicit mapping(const std::string &path)
+  {
+#ifdef _WIN32
+    file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                       FILE_ATTRIBUTE_NORMAL, nullptr);
+    LARGE_INTEGER size;
+    if (file == INVALID_HANDLE_VALUE || !GetFileSizeEx(file, &size))
+      fail(path);
+    length = static_cast<size_t>(size.QuadPart);
+    if (length == 0)
+      return;
+    map = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (map == nullptr)
+      fail(path);
+    bytes = static_cast<const uint8_t *>(MapViewOfFile(map, FILE_MAP_READ, 0, 0, 0));
+    if (bytes == nullptr)
+      fail(path);
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0)
+    {
+      if (fd >= 0)
+        close(fd);
+      fail(path);
+    }
+    length = static_cast<size_t>(st.st_size);
+    if (length == 0)
+    {
+      close(fd);
+      return;
+    }
+    void *address = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+    // mapping stays valid after closing descriptor
+    close(fd);
+    if (address == MAP_FAILED)
+      fail(path);
+    bytes = static_cast<const uint8_t *>(address);
+#endif
+  }
+
+  mapping(const mapping &other) = delete;
+  mapping & operator=(const mapping &other) = delete;
+
+  ~mapping()
+  {
+    release();
+  }
+
+private:
+  void release()
+  {
+#ifdef _WIN32
+    if (bytes != nullptr)
+      UnmapViewOfFile(bytes);
+    if (map != nullptr)
+      CloseHandle(map);
+    if (file != INVALID_HANDLE_VALUE)
+      CloseHandle(file);
+#else
+    if (bytes != nullptr)
+      munmap(const_cast<uint8_t *>(bytes), length);
+#endif
+  }
+
+  [[noreturn]] void fail(const std::string &path)
+  {
+    release();
+    throw std::runtime_error("Cannot map big integer table file '" + path + "'");
+  }
+};
+
+big_integer_table::big_integer_table(const std::string &path) : file(std::make_shared<const mapping>(path)),
+  bytes(file->bytes), length(file->length), count(0)
+{
+  check_header();
+}
+
+big_integer_table::big_integer_table(const uint8_t *first, const uint8_t *last) : bytes(first),
+  length(static_cast<size_t>(last - first)), count(0)
+{
+  check_header();
+}
+
+void big_integer_table::check_header()
+{
+  if (length < TABLE_HEADER_SIZE || std::memcmp(bytes, TABLE_MAGIC, sizeof(TABLE_MAGIC)) != 0)
+    throw std::runtime_error("Invalid big integer table header");
+  uint64_t n = read_uint64(sizeof(TABLE_MAGIC));
+  if (n >= (length - TABLE_HEADER_SIZE) / sizeof(uint64_t))
+    throw std::runtime_error("Big integer table of " + std::to_string(length) + " bytes cannot have " +
+                             std::to_string(n) + " entries");
+  count = static_cast<size_t>(n);
+}
+
+uint64_t big_integer_table::read_uint64(size_t offset) const
+{
+  uint64_t x = 0;
+  for (unsigned i = 0; i < sizeof(uint64_t); i++)
+    x |= uint64_t{bytes[offset + i]} << (8 * i);
+  return x;
+}
+
+size_t big_integer_table::size() const
+{
+  return count;
+}
+
+big_integer big_integer_table::operator[](size_t i) const
+{
+  uint64_t
+    begin = read_uint64(TABLE_HEADER_SIZE + sizeof(uint64_t) * i),
+    end = read_uint64(TABLE_HEADER_SIZE + sizeof(uint64_t) * (i + 1));
+  if (begin < TABLE_HEADER_SIZE + sizeof(uint64_t) * (count + 1) || begin > end || end > length)
+    throw std::runtime_error("Invalid offsets of big integer table entry " + std::to_string(i));
+
+  big_integer res;
+  if (deserialize(bytes + begin, bytes + end, res) != bytes + end)
+    throw std::runtime_error("Big integer table entry " + std::to_string(i) + " has extra bytes");
+  return res;
+}
+
+big_integer big_integer_table::at(size_t i) const
+{
+  if (i >= count)
+    throw std::out_of_range("Big integer table entry " + std::to_string(i) + " of " + std::to_string(count));
+  return (*this)[i];
+}
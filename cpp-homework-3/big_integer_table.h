@@ -0,0 +1,47 @@
+/* Nikolai Kholiavin, M3138 */
+
+#ifndef BIG_INTEGER_TABLE_H
+#define BIG_INTEGER_TABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "big_integer.h"
+
+/* Read-only table of serialized numbers, usually memory-mapped from file:
+ * 8-byte magic "BIGINTBL", little-endian 64-bit count & count + 1 offsets of entries
+ * from the beginning of table (the last one is the end), then entries written by serialize,
+ * entry is deserialized on access without reading others, copies share mapping */
+struct big_integer_table
+{
+  // writes table of values[0, n) to stream
+  static void write(std::ostream &out, const big_integer *values, size_t n);
+  static void write(std::ostream &out, const std::vector<big_integer> &values);
+
+  // maps file read-only, throws std::runtime_error if it cannot be mapped or has no valid header
+  explicit big_integer_table(const std::string &path);
+  // table in bytes [first, last) which must outlive it
+  big_integer_table(const uint8_t *first, const uint8_t *last);
+
+  size_t size() const;
+
+  // throws std::runtime_error if entry is malformed
+  big_integer operator[](size_t i) const;
+  // also throws std::out_of_range for i >= size()
+  big_integer at(size_t i) const;
+
+private:
+  struct mapping;
+  std::shared_ptr<const mapping> file;
+  const uint8_t *bytes;
+  size_t length, count;
+
+  void check_header();
+  uint64_t read_uint64(size_t offset) const;
+};
+
+#endif // BIG_INTEGER_TABLE_H
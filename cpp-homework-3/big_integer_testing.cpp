@@ -1,14 +1,51 @@
 #include <algorithm>
 #include <cassert>
 #include <cstdlib>
+#include <filesystem>
+#include <fstream>
 #include <random>
 #include <vector>
+#include <sstream>
 #include <utility>
 #include <gtest/gtest.h>
 
 #include "big_integer.h"
+#include "big_integer_table.h"
 #include "big_integer_gmp.h"
 
+namespace {
+// tuning parameter changed in test scope, its previous value is restored on any exit from it
+template<typename T>
+class scoped_tuning {
+public:
+  explicit scoped_tuning(T &parameter) : parameter(parameter), saved(parameter) {}
+  scoped_tuning(T &parameter, T value) : scoped_tuning(parameter) {
+    parameter = value;
+  }
+  scoped_tuning(scoped_tuning const &) = delete;
+  scoped_tuning &operator=(scoped_tuning const &) = delete;
+  ~scoped_tuning() {
+    parameter = saved;
+  }
+
+  scoped_tuning &operator=(T value) {
+    parameter = value;
+    return *this;
+  }
+
+  T const &initial() const {
+    return saved;
+  }
+
+private:
+  T &parameter;
+  T const saved;
+};
+
+template<typename T, typename U>
+scoped_tuning(T &, U) -> scoped_tuning<T>;
+}
+
 TEST(correctness, two_plus_two) {
   EXPECT_EQ(big_integer(4), big_integer(2) + big_integer(2));
   EXPECT_EQ(4, big_integer(2) + 2); // implicit converion from int must work
@@ -557,6 +594,211 @@ TEST(correctness, string_conv) {
   EXPECT_EQ("-2147483649", to_string(lim));
 }
 
+TEST(correctness, string_conv_long) {
+  scoped_tuning threshold(big_integer::tuning::conversion_threshold);
+  for (size_t k : {size_t(2), threshold.initial()}) {
+    threshold = k;
+    for (size_t len : {9, 10, 100, 1000, 3000}) {
+      std::string digits(len, '0');
+      for (char &c : digits)
+        c = static_cast<char>('0' + rand() % 10);
+      digits[0] = '1' + rand() % 9;
+      for (std::string const &s : {digits, "-" + digits, std::string(len, '9'), "1" + std::string(len, '0')})
+        EXPECT_EQ(s, to_string(big_integer(s)));
+    }
+  }
+}
+
+TEST(correctness, string_conv_ranges) {
+  std::string s = "x-12345678901234567890y";
+  std::string_view view(s);
+  EXPECT_EQ(big_integer(view.substr(1, 21)), big_integer("-12345678901234567890"));
+  EXPECT_EQ(big_integer(s.begin() + 2, s.end() - 1), big_integer("12345678901234567890"));
+  std::vector<char> digits = {'-', '0', '0', '7'};
+  EXPECT_EQ(big_integer(digits.begin(), digits.end()), -7);
+  EXPECT_EQ(big_integer(std::string(30, '0')), 0);
+
+  for (char const *str : {"", "-", "12a", "1-2", " 1", "--1"})
+    EXPECT_THROW(big_integer{str}, std::runtime_error);
+
+  // only ranges of chars are accepted, explicitly
+  static_assert(!std::is_constructible_v<big_integer, int, int>);
+  static_assert(!std::is_constructible_v<big_integer, std::vector<int>::iterator, std::vector<int>::iterator>);
+  static_assert(std::is_constructible_v<big_integer, std::string::iterator, std::string::iterator>);
+}
+
+TEST(correctness, string_conv_invalid_offset) {
+  for (size_t len : {1, 7, 8, 9, 16, 17, 33, 100}) {
+    std::string digits(len, '0');
+    for (char &c : digits)
+      c = static_cast<char>('0' + rand() % 10);
+    for (size_t at = 0; at < len; at++)
+      for (char bad : {'/', ':', 'a', '\xB0'}) {
+        std::string s = "-" + digits;
+        s[at + 1] = bad;
+        std::string offset = "offset " + std::to_string(at + 1);
+        try {
+          big_integer{s};
+          ADD_FAILURE() << s;
+        } catch (std::runtime_error const &e) {
+          std::string message = e.what();
+          EXPECT_EQ(message.substr(message.size() - offset.size()), offset);
+        }
+        std::vector<char> v(s.begin(), s.end());
+        EXPECT_THROW((big_integer{v.begin(), v.end()}), std::runtime_error);
+      }
+    EXPECT_EQ(to_string(big_integer(digits.begin(), digits.end())), to_string(big_integer(digits)));
+  }
+}
+
+TEST(correctness, string_conv_bases) {
+  big_integer ones = (big_integer(1) << 100) - 1;
+  EXPECT_EQ(to_string(ones, 16), std::string(25, 'f'));
+  EXPECT_EQ(to_string(-ones - 1, 2), "-1" + std::string(100, '0'));
+  EXPECT_EQ(to_string(big_integer(-255), 8), "-377");
+  EXPECT_EQ(to_string(big_integer(0), 32), "0");
+  EXPECT_EQ(to_string(big_integer(35), 36), "z");
+  EXPECT_EQ(big_integer("-FfFfFfFfFfFfFfFfFfFfFfFfF", 16), -ones);
+  EXPECT_EQ(big_integer("zz", 36), 36 * 36 - 1);
+  EXPECT_THROW(big_integer("12", 2), std::runtime_error);
+  EXPECT_THROW(big_integer("12", 37), std::invalid_argument);
+  EXPECT_THROW(to_string(ones, 1), std::invalid_argument);
+
+  for (int base = 2; base <= 36; base++) {
+    for (size_t len : {1, 31, 32, 33, 500}) {
+      std::string digits(len, '0');
+      for (char &c : digits)
+        c = "0123456789abcdefghijklmnopqrstuvwxyz"[rand() % base];
+      digits[0] = "123456789abcdefghijklmnopqrstuvwxyz"[rand() % (base - 1)];
+      big_integer a(digits, base);
+      EXPECT_EQ(to_string(a, base), digits);
+      EXPECT_EQ(to_string(-a, base), "-" + digits);
+      EXPECT_EQ(big_integer(to_string(a), 10), a);
+    }
+  }
+}
+
+TEST(correctness, string_conv_chars) {
+  char buf[64];
+  big_integer a("-123456789012345678901234567890");
+  std::to_chars_result out = to_chars(buf, buf + sizeof(buf), a);
+  EXPECT_EQ(out.ec, std::errc());
+  EXPECT_EQ(std::string(buf, out.ptr), "-123456789012345678901234567890");
+  out = to_chars(buf, buf + 30, a);
+  EXPECT_EQ(out.ec, std::errc::value_too_large);
+  out = to_chars(buf, buf + 31, a);
+  EXPECT_EQ(out.ec, std::errc());
+  EXPECT_EQ(out.ptr, buf + 31);
+
+  const char str[] = "-ff0g";
+  big_integer b = 1;
+  std::from_chars_result in = from_chars(str, str + 5, b, 16);
+  EXPECT_EQ(in.ec, std::errc());
+  EXPECT_EQ(in.ptr, str + 4);
+  EXPECT_EQ(b, -0xff0);
+  in = from_chars(str, str + 1, b);
+  EXPECT_EQ(in.ec, std::errc::invalid_argument);
+  EXPECT_EQ(in.ptr, str);
+  EXPECT_EQ(b, -0xff0);
+
+  for (int base = 2; base <= 36; base++) {
+    for (size_t bits : {0, 1, 31, 32, 33, 64, 1000, 3000}) {
+      for (big_integer x : {big_integer(1) << bits, (big_integer(1) << bits) - 1, -(big_integer(1) << bits),
+                            -(big_integer(1) << bits) + 1}) {
+        std::string digits = to_string(x, base);
+        size_t bound = to_chars_size(x, base);
+        EXPECT_GE(bound, digits.size());
+        EXPECT_LE(bound, digits.size() + 3);
+        std::string chars(bound, '\0');
+        out = to_chars(&chars[0], &chars[0] + bound, x, base);
+        EXPECT_EQ(std::string(&chars[0], out.ptr), digits);
+        big_integer y;
+        in = from_chars(chars.data(), out.ptr, y, base);
+        EXPECT_EQ(in.ptr, out.ptr);
+        EXPECT_EQ(y, x);
+      }
+    }
+  }
+}
+
+TEST(correctness, string_conv_incremental) {
+  for (size_t len : {1, 7, 8, 9, 63 * 8 + 5, 64 * 8, 3 * 64 * 8 + 17, 20000}) {
+    std::string digits(len, '0');
+    for (char &c : digits)
+      c = static_cast<char>('0' + rand() % 10);
+    digits = "-" + digits;
+    big_integer_parser parser;
+    for (size_t i = 0; i < digits.size();) {
+      size_t n = std::min(digits.size() - i, static_cast<size_t>(rand() % 100));
+      parser.feed(digits.data() + i, n);
+      i += n;
+    }
+    EXPECT_EQ(parser.size(), digits.size());
+    EXPECT_EQ(parser.finish(), big_integer(digits));
+    EXPECT_THROW(parser.finish(), std::runtime_error);
+  }
+
+  big_integer_parser parser;
+  parser.feed("123456789");
+  EXPECT_THROW(parser.feed("01-"), std::runtime_error);
+  parser.reset();
+  parser.feed("-");
+  EXPECT_THROW(parser.finish(), std::runtime_error);
+
+  std::istringstream in("  -123 00456\n789x -");
+  big_integer a, b, c;
+  in >> a >> b >> c;
+  EXPECT_EQ(a, -123);
+  EXPECT_EQ(b, 456);
+  EXPECT_EQ(c, 789);
+  EXPECT_TRUE(in.good());
+  in >> a;
+  EXPECT_TRUE(in.fail());
+  EXPECT_EQ(a, -123);
+}
+
+TEST(correctness, serialization) {
+  std::vector<big_integer> values = {0, 1, -1, 63, -64, 64, std::numeric_limits<int>::max(),
+                                     std::numeric_limits<int>::min(), big_integer(1) << 31,
+                                     -(big_integer(1) << 31) - 1, big_integer("-123456789012345678901234567890"),
+                                     (big_integer(1) << 10000) - 1};
+  EXPECT_EQ(serialize(big_integer(-32)).size(), 1u);
+  EXPECT_EQ(serialize(big_integer(1) << 31).size(), 9u);
+
+  std::vector<uint8_t> bytes;
+  for (big_integer const &a : values) {
+    std::vector<uint8_t> entry = serialize(a);
+    EXPECT_EQ(entry.size(), serialized_size(a));
+    bytes.insert(bytes.end(), entry.begin(), entry.end());
+  }
+  const uint8_t *it = bytes.data();
+  for (big_integer const &a : values) {
+    big_integer b;
+    it = deserialize(it, bytes.data() + bytes.size(), b);
+    EXPECT_EQ(b, a);
+  }
+  EXPECT_EQ(it, bytes.data() + bytes.size());
+
+  big_integer b = 5;
+  std::vector<uint8_t> entry = serialize(values.back());
+  EXPECT_THROW(deserialize(entry.data(), entry.data() + entry.size() - 1, b), std::runtime_error);
+  EXPECT_THROW(deserialize(entry.data(), entry.data(), b), std::runtime_error);
+  EXPECT_EQ(b, 5);
+
+  std::ostringstream out;
+  big_integer_table::write(out, values);
+  std::string table = out.str();
+  big_integer_table reader(reinterpret_cast<const uint8_t *>(table.data()),
+                           reinterpret_cast<const uint8_t *>(table.data() + table.size()));
+  ASSERT_EQ(reader.size(), values.size());
+  for (size_t i = values.size(); i-- > 0;)
+    EXPECT_EQ(reader[i], values[i]);
+  EXPECT_THROW(reader.at(values.size()), std::out_of_range);
+  EXPECT_THROW(big_integer_table(reinterpret_cast<const uint8_t *>(table.data()),
+                                 reinterpret_cast<const uint8_t *>(table.data() + 20)),
+               std::runtime_error);
+}
+
 namespace {
 size_t const number_of_iterations = 10;
 size_t const max_size = 2048;
@@ -670,6 +912,427 @@ TEST(correctness, div_randomized) {
   }
 }
 
+TEST(correctness, div_max_places) {
+  for (int bits : {64, 96, 320}) {
+    big_integer divisor = (big_integer(1) << bits) - 1;
+    big_integer quotient = rand_big(5);
+    EXPECT_EQ(quotient * divisor / divisor, quotient);
+    EXPECT_EQ((quotient * divisor - 1) / divisor, quotient - 1);
+    EXPECT_EQ((quotient * divisor - 1) % divisor, divisor - 1);
+  }
+}
+
+TEST(correctness, div_add_back) {
+  // quotient digit estimate is too big, divisor is added back
+  big_integer a("730750818665451472447975099350399345638578827558");
+  big_integer b("39614081257132169522414761275");
+  big_integer q = a / b, r = a % b;
+  EXPECT_EQ(q * b + r, a);
+  EXPECT_TRUE(r >= 0 && r < b);
+  EXPECT_EQ(-a / b, -q);
+  EXPECT_EQ((a << 5) / (b << 5), q);
+  EXPECT_EQ((a << 5) % (b << 5), r << 5);
+}
+
+TEST(correctness, div_burnikel_ziegler) {
+  scoped_tuning threshold(big_integer::tuning::burnikel_ziegler_threshold);
+  for (size_t size : {10, 50, 300}) {
+    big_integer b = rand_big(size);
+    big_integer max_b = (big_integer(1) << (32 * size)) - 1;
+    for (big_integer a : {rand_big(size * 2), -rand_big(size * 5), rand_big(size) * b - 1, max_b * max_b}) {
+      threshold = 4;
+      big_integer q = a / b, r = a % b, q_max = a / max_b, r_max = a % max_b;
+      threshold = std::numeric_limits<size_t>::max();
+      EXPECT_EQ(a / b, q);
+      EXPECT_EQ(a % b, r);
+      EXPECT_EQ(a / max_b, q_max);
+      EXPECT_EQ(a % max_b, r_max);
+    }
+  }
+}
+
+TEST(correctness, div_newton) {
+  scoped_tuning threshold(big_integer::tuning::newton_division_threshold);
+  for (size_t size : {10, 50, 300}) {
+    big_integer b = rand_big(size);
+    big_integer max_b = (big_integer(1) << (32 * size)) - 1;
+    for (big_integer a : {rand_big(size * 2), -rand_big(size * 5), rand_big(size) * b - 1, max_b * max_b}) {
+      threshold = 4;
+      big_integer q = a / b, r = a % b, q_max = a / max_b, r_max = a % max_b;
+      threshold = std::numeric_limits<size_t>::max();
+      EXPECT_EQ(a / b, q);
+      EXPECT_EQ(a % b, r);
+      EXPECT_EQ(a / max_b, q_max);
+      EXPECT_EQ(a % max_b, r_max);
+    }
+  }
+}
+
+TEST(correctness, div_by_zero) {
+  big_integer zero, long_a = rand_big(50);
+  for (big_integer const &a : {big_integer(12345), long_a, -long_a, zero}) {
+    EXPECT_THROW(a / zero, std::domain_error);
+    EXPECT_THROW(a % 0, std::domain_error);
+    EXPECT_THROW(divmod(a, zero), std::domain_error);
+    EXPECT_THROW(divexact(a, zero), std::domain_error);
+  }
+  EXPECT_THROW(big_integer_divisor{zero}, std::domain_error);
+  big_integer a = long_a;
+  EXPECT_THROW(a /= 0, std::domain_error);
+  EXPECT_EQ(a, long_a);
+}
+
+TEST(correctness, div_short) {
+  big_integer ones = (big_integer(1) << (32 * 20)) - 1;
+  for (big_integer const &b : {big_integer(1), big_integer(3), big_integer(1) << 31, (big_integer(1) << 32) - 1,
+                               (big_integer(1) << 31) + 1, (big_integer(1) << 63) + 1, (big_integer(1) << 64) - 1,
+                               rand_big(2)}) {
+    big_integer_divisor d(b);
+    for (big_integer const &a : {rand_big(20), ones, -ones, rand_big(20) * b + b - 1}) {
+      big_integer q = a / b, r = a % b;
+      EXPECT_EQ(q * b + r, a);
+      EXPECT_TRUE(a >= 0 ? r >= 0 && r < b : r <= 0 && -r < b);
+      EXPECT_EQ(d.divmod(a), std::make_pair(q, r));
+    }
+  }
+}
+
+TEST(correctness, div_divisor) {
+  for (size_t size : {1, 2, 10, 50, 300}) {
+    big_integer b = -rand_big(size);
+    big_integer max_b = (big_integer(1) << (32 * size)) - 1;
+    big_integer_divisor d(b), d_max(max_b);
+    EXPECT_EQ(d.divisor(), b);
+    for (big_integer a : {big_integer(0), rand_big(size * 2), -rand_big(size * 5), rand_big(size) * b - 1,
+                          max_b * max_b, rand_big(size / 2 + 1)}) {
+      EXPECT_EQ(d.div(a), a / b);
+      EXPECT_EQ(d.mod(a), a % b);
+      EXPECT_EQ(d_max.divmod(a), std::make_pair(a / max_b, a % max_b));
+    }
+  }
+}
+
+TEST(correctness, div_divisor_reciprocal) {
+  scoped_tuning threshold(big_integer::tuning::newton_division_threshold);
+  for (size_t k : {size_t(4), size_t(100), threshold.initial()}) {
+    threshold = k;
+    for (size_t size : {30, 200, 1000}) {
+      big_integer max_b = (big_integer(1) << (32 * size)) - 1;
+      for (big_integer const &b : {rand_big(size), max_b, (big_integer(1) << (32 * size - 1)) + 1}) {
+        big_integer_divisor d(b);
+        for (big_integer const &a : {rand_big(size * 2), max_b * max_b, b * b - 1}) {
+          auto qr = d.divmod(a);
+          EXPECT_EQ(qr.first * b + qr.second, a);
+          EXPECT_TRUE(qr.second >= 0 && qr.second < b);
+        }
+      }
+    }
+  }
+}
+
+TEST(correctness, div_divmod) {
+  EXPECT_EQ(divmod(big_integer(-7), 2), std::make_pair(big_integer(-3), big_integer(-1)));
+  EXPECT_EQ(floor_divmod(big_integer(-7), 2), std::make_pair(big_integer(-4), big_integer(1)));
+  EXPECT_EQ(floor_divmod(big_integer(7), -2), std::make_pair(big_integer(-4), big_integer(-1)));
+  EXPECT_EQ(euclid_divmod(big_integer(-7), -2), std::make_pair(big_integer(4), big_integer(1)));
+  EXPECT_EQ(euclid_divmod(big_integer(-6), -2), std::make_pair(big_integer(3), big_integer(0)));
+
+  for (size_t size : {1, 10, 50}) {
+    big_integer a = rand_big(size * 2), b = rand_big(size);
+    for (int signs = 0; signs < 4; signs++) {
+      big_integer x = signs & 1 ? -a : a, y = signs & 2 ? -b : b;
+      auto qr = divmod(x, y), fqr = floor_divmod(x, y), eqr = euclid_divmod(x, y);
+      EXPECT_EQ(qr, std::make_pair(x / y, x % y));
+      EXPECT_EQ(fqr.first * y + fqr.second, x);
+      EXPECT_TRUE(y > 0 ? fqr.second >= 0 && fqr.second < y : fqr.second <= 0 && fqr.second > y);
+      EXPECT_EQ(eqr.first * y + eqr.second, x);
+      EXPECT_TRUE(eqr.second >= 0 && eqr.second < b);
+    }
+  }
+}
+
+TEST(correctness, div_exact) {
+  scoped_tuning threshold(big_integer::tuning::burnikel_ziegler_threshold);
+  EXPECT_EQ(divexact(big_integer(0), 5), 0);
+  EXPECT_EQ(divexact(big_integer(-12), 4), -3);
+  EXPECT_EQ(divexact(big_integer(1) << 200, big_integer(1) << 100), big_integer(1) << 100);
+  for (size_t k : {size_t(4), threshold.initial()}) {
+    threshold = k;
+    for (size_t size : {1, 2, 10, 50, 300}) {
+      big_integer a = rand_big(size), ones = (big_integer(1) << (32 * size)) - 1;
+      for (big_integer const &b : {-rand_big(size / 2 + 1), rand_big(size * 2) << 37, ones, a}) {
+        EXPECT_EQ(divexact(a * b, b), a);
+        EXPECT_EQ(divexact(b * -a, a), -b);
+      }
+    }
+  }
+}
+
+TEST(correctness, mul_basecase_carries) {
+  for (int k = 1; k <= 40; k++) {
+    big_integer a = (big_integer(1) << (32 * k)) - 1;
+    for (int m = 1; m <= k; m++) {
+      big_integer b = (big_integer(1) << (32 * m)) - 1;
+      EXPECT_EQ(a * b, (big_integer(1) << (32 * (k + m))) - (a + 1) - (b + 1) + 1);
+    }
+    EXPECT_EQ(sqr(a), (big_integer(1) << (64 * k)) - ((a + 1) << 1) + 1);
+  }
+}
+
+TEST(correctness, mul_karatsuba) {
+  for (size_t size : {10, 50, 100, 300, 1000}) {
+    big_integer a = rand_big(size);
+    big_integer b = -rand_big(size * 2 / 3);
+    big_integer c = rand_big(size / 5);
+
+    scoped_tuning threshold(big_integer::tuning::karatsuba_threshold, 4);
+    big_integer ab = a * b, ac = a * c, aa = a;
+    aa *= aa;
+    threshold = std::numeric_limits<size_t>::max();
+    EXPECT_EQ(a * b, ab);
+    EXPECT_EQ(a * c, ac);
+    EXPECT_EQ(a * a, aa);
+  }
+}
+
+TEST(correctness, mul_unbalanced) {
+  big_integer a = -rand_big(3000);
+  for (size_t size : {40, 150, 700, 1300}) {
+    big_integer b = rand_big(size);
+
+    big_integer ab = a * b, ba = b * a;
+    scoped_tuning threshold(big_integer::tuning::karatsuba_threshold, std::numeric_limits<size_t>::max());
+    EXPECT_EQ(a * b, ab);
+    EXPECT_EQ(b * a, ba);
+  }
+}
+
+TEST(correctness, mul_toom_cook) {
+  for (size_t size : {30, 100, 300, 1000, 3000}) {
+    big_integer a = rand_big(size);
+    big_integer b = -rand_big(size * 4 / 5);
+    big_integer c = rand_big(size - 1);
+
+    scoped_tuning toom3_threshold(big_integer::tuning::toom3_threshold, 8);
+    scoped_tuning toom4_threshold(big_integer::tuning::toom4_threshold, std::numeric_limits<size_t>::max());
+    big_integer ab3 = a * b, ac3 = a * c;
+    toom4_threshold = 16;
+    big_integer ab4 = a * b, ac4 = a * c;
+    toom3_threshold = std::numeric_limits<size_t>::max();
+    toom4_threshold = std::numeric_limits<size_t>::max();
+    EXPECT_EQ(a * b, ab3);
+    EXPECT_EQ(a * c, ac3);
+    EXPECT_EQ(a * b, ab4);
+    EXPECT_EQ(a * c, ac4);
+  }
+}
+
+TEST(correctness, mul_ntt) {
+  scoped_tuning ntt(big_integer::tuning::ntt);
+  for (size_t size : {1, 10, 100, 1000, 3000}) {
+    big_integer a = rand_big(size);
+    big_integer b = -rand_big(size / 2 + 1);
+
+    ntt = big_integer::tuning::mode::forced;
+    big_integer ab = a * b, aa = a * a;
+    ntt = big_integer::tuning::mode::disabled;
+    EXPECT_EQ(a * b, ab);
+    EXPECT_EQ(a * a, aa);
+  }
+
+  // greatest possible convolution coefficients
+  big_integer ones = (big_integer(1) << (32 * 20000)) - 1;
+  ntt = big_integer::tuning::mode::forced;
+  big_integer square = ones * ones;
+  ntt = big_integer::tuning::mode::disabled;
+  EXPECT_EQ(ones * ones, square);
+}
+
+TEST(correctness, sqr) {
+  EXPECT_EQ(sqr(big_integer(0)), 0);
+  EXPECT_EQ(sqr(big_integer(-7)), 49);
+  EXPECT_EQ(sqr(big_integer(std::numeric_limits<int>::min())),
+            big_integer(std::numeric_limits<int>::min()) * std::numeric_limits<int>::min());
+
+  for (size_t size : {2, 10, 50, 100, 300, 1000, 3000}) {
+    big_integer a = -rand_big(size);
+    big_integer b = a + 0; // not sharing data with a
+    big_integer c = a;     // sharing data with a
+    big_integer product = a * b;
+
+    EXPECT_EQ(sqr(a), product);
+    c *= c;
+    EXPECT_EQ(c, product);
+    b *= b;
+    EXPECT_EQ(b, product);
+    EXPECT_EQ(a * a, product);
+  }
+}
+
+TEST(correctness, div_self) {
+  for (size_t size : {1, 2, 10, 100}) {
+    for (big_integer const &a : {-rand_big(size), rand_big(size), big_integer(-7)}) {
+      big_integer b = a + 0; // not sharing data with a
+      big_integer c = a;     // sharing data with a
+      b /= b;
+      EXPECT_EQ(b, 1);
+      c /= c;
+      EXPECT_EQ(c, 1);
+      b = a + 0;
+      c = a;
+      b %= b;
+      EXPECT_EQ(b, 0);
+      c %= c;
+      EXPECT_EQ(c, 0);
+      EXPECT_EQ(a / a, 1);
+      EXPECT_EQ(divmod(a, a), std::make_pair(big_integer(1), big_integer(0)));
+    }
+  }
+}
+
+TEST(correctness, mul_parallel) {
+  scoped_tuning threads(big_integer::tuning::threads, 3);
+  scoped_tuning ntt(big_integer::tuning::ntt);
+  scoped_tuning parallel(big_integer::tuning::parallel);
+  for (size_t size : {10, 300, 3000}) {
+    big_integer a = rand_big(size);
+    big_integer b = -rand_big(size / 3 + 1);
+    big_integer c = rand_big(size - 1);
+
+    for (auto mode : {big_integer::tuning::mode::forced, big_integer::tuning::mode::disabled}) {
+      ntt = mode;
+      parallel = big_integer::tuning::mode::forced;
+      big_integer ab = a * b, ac = a * c, aa = sqr(a);
+      parallel = big_integer::tuning::mode::disabled;
+      EXPECT_EQ(a * b, ab);
+      EXPECT_EQ(a * c, ac);
+      EXPECT_EQ(sqr(a), aa);
+    }
+  }
+}
+
+TEST(correctness, string_conv_parallel) {
+  scoped_tuning threshold(big_integer::tuning::conversion_threshold);
+  scoped_tuning parallel(big_integer::tuning::parallel);
+
+  // tasks of conversion are run while waiting for multiplications preparing powers of 10
+  {
+    scoped_tuning threads(big_integer::tuning::threads, 2);
+    scoped_tuning ntt(big_integer::tuning::ntt, big_integer::tuning::mode::forced);
+    scoped_tuning newton_threshold(big_integer::tuning::newton_division_threshold, 4);
+    threshold = 2;
+    std::string digits(54000, '0');
+    for (char &c : digits)
+      c = static_cast<char>('0' + rand() % 10);
+    digits[0] = '1';
+    parallel = big_integer::tuning::mode::forced;
+    big_integer a(digits);
+    EXPECT_EQ(to_string(a), digits);
+  }
+
+  scoped_tuning threads(big_integer::tuning::threads, 3);
+  for (size_t k : {size_t(2), threshold.initial()}) {
+    threshold = k;
+    for (size_t size : {10, 3000, 10000}) {
+      for (big_integer const &a : {rand_big(size), -rand_big(size), big_integer(1) << (32 * size)}) {
+        parallel = big_integer::tuning::mode::forced;
+        std::string s = to_string(a);
+        big_integer b(s);
+        parallel = big_integer::tuning::mode::disabled;
+        EXPECT_EQ(s, to_string(a));
+        EXPECT_EQ(b, a);
+      }
+    }
+  }
+}
+
+TEST(correctness, serialization_mapped_table) {
+  std::vector<big_integer> values;
+  for (size_t i = 0; i < 200; i++)
+    values.push_back(i % 3 == 0 ? big_integer(static_cast<int>(i)) - 100 : rand_big(i % 50 + 1));
+  std::string path = (std::filesystem::temp_directory_path() / "big_integer_table_test.bin").string();
+  {
+    std::ofstream out(path, std::ios::binary);
+    big_integer_table::write(out, values);
+  }
+  {
+    big_integer_table table(path);
+    ASSERT_EQ(table.size(), values.size());
+    for (size_t i = 0; i < values.size(); i++) {
+      size_t j = i * 97 % values.size();
+      EXPECT_EQ(table.at(j), values[j]);
+    }
+    // copies share mapping
+    big_integer_table copy = table;
+    EXPECT_EQ(copy[values.size() - 1], values.back());
+  }
+
+  std::ofstream(path, std::ios::binary | std::ios::trunc).close();
+  EXPECT_THROW(big_integer_table{path}, std::runtime_error);
+  std::ofstream(path, std::ios::binary | std::ios::trunc) << "not a big integer table at all";
+  EXPECT_THROW(big_integer_table{path}, std::runtime_error);
+  std::filesystem::remove(path);
+  EXPECT_THROW(big_integer_table{path}, std::runtime_error);
+}
+
+TEST(correctness, mul_multiplier) {
+  for (size_t size : {0, 10, 300, 3000}) {
+    big_integer f = -rand_big(size);
+    big_integer_multiplier m(f);
+    EXPECT_EQ(m.factor(), f);
+    std::vector<big_integer> values = {0, rand_big(size / 2 + 1), -rand_big(size * 2 + 1), f};
+    for (auto mode : {big_integer::tuning::mode::forced, big_integer::tuning::mode::disabled}) {
+      scoped_tuning ntt(big_integer::tuning::ntt, mode);
+      for (big_integer const &a : values) {
+        big_integer b = a;
+        b *= m;
+        EXPECT_EQ(b, a * f);
+        EXPECT_EQ(m * a, a * f);
+      }
+    }
+  }
+}
+
+TEST(correctness, mul_multiplier_splits) {
+  scoped_tuning karatsuba_threshold(big_integer::tuning::karatsuba_threshold, 4);
+  scoped_tuning toom3_threshold(big_integer::tuning::toom3_threshold, 12);
+  scoped_tuning toom4_threshold(big_integer::tuning::toom4_threshold, 24);
+  scoped_tuning ntt(big_integer::tuning::ntt, big_integer::tuning::mode::disabled);
+  for (size_t size : {5, 30, 100}) {
+    // factor with zero chunks in the middle
+    for (big_integer const &f : {rand_big(size), (rand_big(size) << (32 * 2 * size)) + rand_big(1)}) {
+      big_integer_multiplier m(f);
+      // more partner sizes than splits kept for operand, products with kept ones are repeated
+      for (int repeat = 0; repeat < 2; repeat++)
+        for (size_t n : {size / 3 + 1, size / 2, size - 1, size, size * 2 / 3, size * 4 / 5, size * 3, size * 7}) {
+          big_integer a = -rand_big(n);
+          EXPECT_EQ(a * m, a * f);
+        }
+    }
+  }
+}
+
+TEST(correctness, mul_short_products) {
+  scoped_tuning threshold(big_integer::tuning::karatsuba_threshold);
+  for (size_t k : {size_t(4), size_t(32)}) {
+    threshold = k;
+    for (size_t size : {1, 7, 50, 300}) {
+      big_integer a = rand_big(size);
+      big_integer b = -rand_big(size * 2 / 3);
+      big_integer ones = (big_integer(1) << (32 * size)) - 1;
+
+      for (size_t n : {size_t(0), size / 3, size, size * 3 / 2, size * 3}) {
+        big_integer base = big_integer(1) << (32 * n);
+        EXPECT_EQ(mul_low(a, b, n), a * b % base);
+        EXPECT_EQ(mul_high(a, b, n), a * b / base);
+        EXPECT_EQ(mul_high(ones, ones, n), ones * ones / base);
+        EXPECT_EQ(mul_high(a, a, n), a * a / base);
+        EXPECT_EQ(mul_middle(b, a, n / 2, n), b * a / (big_integer(1) << (32 * (n / 2))) % (base >> (32 * (n / 2))));
+      }
+    }
+  }
+}
+
 // y2019 tests
 
 TEST(correctness_random, cmp) {
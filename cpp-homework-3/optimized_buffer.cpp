@@ -235,6 +235,12 @@ namespace big_int_util
     return !operator==(other);
   }
 
+  bool optimized_buffer::is_same_data(const optimized_buffer &other) const
+  {
+    return this == &other || (is_dynamic_data() && other.is_dynamic_data() &&
+      dynamic_data == other.dynamic_data && size() == other.size());
+  }
+
   optimized_buffer::~optimized_buffer()
   {
     if (is_dynamic_data())
@@ -163,6 +163,8 @@ namespace big_int_util
 
     bool operator==(const optimized_buffer &other) const;
     bool operator!=(const optimized_buffer &other) const;
+    // checks if buffers are the same or share data (without comparing it)
+    bool is_same_data(const optimized_buffer &other) const;
 
     ~optimized_buffer();
   };
@@ -0,0 +1,540 @@
+/* Nikolai Kholiavin, M3138 */
+#include <algorithm>
+#include <cstring>
+
+#include "place_arithmetic.h"
+
+// x86-64 kernels with mulx (BMI2) & adcx/adox (ADX) instructions
+// & decimal digits kernels with SSE4.1 or AVX2, selected at run time
+#if defined(__x86_64__) || defined(_M_X64)
+#  define PLACE_ARITHMETIC_X86_64
+#  include <immintrin.h>
+#  ifdef _MSC_VER
+#    include <intrin.h>
+#    define TARGET_BMI2_ADX
+#    define TARGET_SSE41
+#    define TARGET_AVX2
+#    define TARGET_XSAVE
+#  else
+#    include <cpuid.h>
+#    define TARGET_BMI2_ADX __attribute__((target("bmi2,adx")))
+#    define TARGET_SSE41 __attribute__((target("sse4.1")))
+#    define TARGET_AVX2 __attribute__((target("avx2")))
+#    define TARGET_XSAVE __attribute__((target("xsave")))
+#  endif
+#endif
+
+namespace big_int_util
+{
+  static inline uint32_t low_bytes(uint64_t x) { return x & 0xFFFFFFFF; }
+  static inline uint32_t high_bytes(uint64_t x) { return x >> 32; }
+
+  uint32_t add_n(uint32_t *res, const uint32_t *a, const uint32_t *b, size_t n)
+  {
+    uint64_t carry = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+      carry += uint64_t{a[i]} + b[i];
+      res[i] = low_bytes(carry);
+      carry = high_bytes(carry);
+    }
+    return static_cast<uint32_t>(carry);
+  }
+
+  uint32_t sub_n(uint32_t *res, const uint32_t *a, const uint32_t *b, size_t n)
+  {
+    uint64_t borrow = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+      uint64_t diff = uint64_t{a[i]} - b[i] - borrow;
+      res[i] = low_bytes(diff);
+      borrow = diff >> 63;
+    }
+    return static_cast<uint32_t>(borrow);
+  }
+
+  uint32_t add(uint32_t *res, const uint32_t *a, size_t an, const uint32_t *b, size_t bn)
+  {
+    uint32_t carry = add_n(res, a, b, bn);
+    for (size_t i = bn; i < an; i++)
+    {
+      res[i] = a[i] + carry;
+      carry = carry && res[i] == 0;
+    }
+    return carry;
+  }
+
+  uint32_t add_1(uint32_t *res, const uint32_t *a, size_t n, uint32_t b)
+  {
+    size_t i = 0;
+    for (; i < n && b != 0; i++)
+    {
+      res[i] = a[i] + b;
+      b = res[i] < b;
+    }
+    if (res != a)
+      std::copy(a + i, a + n, res + i);
+    return b;
+  }
+
+  uint32_t sub(uint32_t *res, const uint32_t *a, size_t an, const uint32_t *b, size_t bn)
+  {
+    uint32_t borrow = sub_n(res, a, b, bn);
+    for (size_t i = bn; i < an; i++)
+    {
+      uint32_t place = a[i];
+      res[i] = place - borrow;
+      borrow = borrow && place == 0;
+    }
+    return borrow;
+  }
+
+  uint32_t mul_1(uint32_t *res, const uint32_t *a, size_t n, uint32_t b)
+  {
+    uint64_t carry = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+      carry += uint64_t{a[i]} * b;
+      res[i] = low_bytes(carry);
+      carry = high_bytes(carry);
+    }
+    return static_cast<uint32_t>(carry);
+  }
+
+  uint32_t addmul_1(uint32_t *res, const uint32_t *a, size_t n, uint32_t b)
+  {
+    // (2^32 - 1)^2 + 2 * (2^32 - 1) = 2^64 - 1, so no overflow
+    uint64_t carry = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+      carry += uint64_t{a[i]} * b + res[i];
+      res[i] = low_bytes(carry);
+      carry = high_bytes(carry);
+    }
+    return static_cast<uint32_t>(carry);
+  }
+
+  uint32_t submul_1(uint32_t *res, const uint32_t *a, size_t n, uint32_t b)
+  {
+    // res[i] + (2^32 - 1) * 2^32 - a[i] * b - borrow does not overflow and is not negative,
+    // its high place is 2^32 - 1 - next borrow (one dependency chain as in addmul_1)
+    uint32_t borrow = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+      uint64_t diff = uint64_t{res[i]} + (uint64_t{0xFFFFFFFF} << 32) - uint64_t{a[i]} * b - borrow;
+      res[i] = low_bytes(diff);
+      borrow = ~high_bytes(diff);
+    }
+    return borrow;
+  }
+
+  uint32_t lshift(uint32_t *res, const uint32_t *a, size_t n, unsigned bits)
+  {
+    if (n == 0)
+      return 0;
+    // from high places for in place shift
+    uint32_t out = a[n - 1] >> (32 - bits);
+    for (size_t i = n - 1; i > 0; i--)
+      res[i] = (a[i] << bits) | (a[i - 1] >> (32 - bits));
+    res[0] = a[0] << bits;
+    return out;
+  }
+
+  uint32_t rshift(uint32_t *res, const uint32_t *a, size_t n, unsigned bits)
+  {
+    if (n == 0)
+      return 0;
+    uint32_t out = a[0] << (32 - bits);
+    for (size_t i = 0; i + 1 < n; i++)
+      res[i] = (a[i] >> bits) | (a[i + 1] << (32 - bits));
+    res[n - 1] = a[n - 1] >> bits;
+    return out;
+  }
+
+  static void mul_basecase_portable(uint32_t *res, const uint32_t *a, size_t an, const uint32_t *b, size_t bn)
+  {
+    res[an] = mul_1(res, a, an, b[0]);
+    for (size_t i = 1; i < bn; i++)
+      res[i + an] = addmul_1(res + i, a, an, b[i]);
+  }
+
+  static void sqr_basecase_portable(uint32_t *res, const uint32_t *a, size_t n)
+  {
+    // off-diagonal products, i < j
+    res[0] = 0;
+    res[2 * n - 1] = 0;
+    if (n > 1)
+      res[n] = mul_1(res + 1, a + 1, n - 1, a[0]);
+    for (size_t i = 1; i + 1 < n; i++)
+      res[i + n] = addmul_1(res + 2 * i + 1, a + i + 1, n - i - 1, a[i]);
+
+    // double & add diagonal squares
+    uint32_t high_bit = 0;
+    uint64_t carry = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+      uint64_t square = uint64_t{a[i]} * a[i];
+      uint32_t low = res[2 * i], high = res[2 * i + 1];
+      carry += uint64_t{(low << 1) | high_bit} + low_bytes(square);
+      res[2 * i] = low_bytes(carry);
+      carry = high_bytes(carry);
+      carry += uint64_t{(high << 1) | (low >> 31)} + high_bytes(square);
+      res[2 * i + 1] = low_bytes(carry);
+      carry = high_bytes(carry);
+      high_bit = high >> 31;
+    }
+  }
+
+#ifdef PLACE_ARITHMETIC_X86_64
+  static bool cpu_supports_bmi2_adx()
+  {
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+      return false;
+    __cpuidex(info, 7, 0);
+    uint32_t ebx = static_cast<uint32_t>(info[1]);
+#else
+    unsigned eax, ebx, ecx, edx;
+    if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx))
+      return false;
+#endif
+    // EBX bit 8 -- BMI2, bit 19 -- ADX
+    return (ebx >> 8 & 1) && (ebx >> 19 & 1);
+  }
+
+  // 64-bit words of place arrays (2 places each, no alignment)
+  static inline unsigned long long load_word(const uint32_t *places)
+  {
+    unsigned long long word;
+    std::memcpy(&word, places, sizeof(word));
+    return word;
+  }
+
+  static inline void store_word(uint32_t *places, unsigned long long word)
+  {
+    std::memcpy(places, &word, sizeof(word));
+  }
+
+  // words res[0, n) (+)= a[0, n) * b, returns high word,
+  // low halves of products & previous high halves are summed in CF chain (adcx),
+  // these sums & res words -- in independent OF chain (adox)
+  template<bool accumulate>
+    TARGET_BMI2_ADX static unsigned long long addmul_1_adx(uint32_t *res, const uint32_t *a, size_t n,
+                                                           unsigned long long b)
+    {
+#ifdef __GNUC__
+      // compilers save flags between _addcarryx_u64 calls, so loop is written in assembly:
+      // index goes from -n to 0 by lea & jrcxz which do not change flags
+      if (n == 0)
+        return 0;
+      unsigned long long high = 0, low, next_high, zero = 0;
+      long long i = -static_cast<long long>(n);
+      const uint32_t *a_end = a + 2 * n;
+      uint32_t *res_end = res + 2 * n;
+      if (accumulate)
+        __asm__(
+          "xor %k[low], %k[low]\n\t" // clears CF & OF
+          "1:\n\t"
+          "mulx (%[a], %[i], 8), %[low], %[next_high]\n\t"
+          "adcx %[high], %[low]\n\t"
+          "adox (%[res], %[i], 8), %[low]\n\t"
+          "mov %[low], (%[res], %[i], 8)\n\t"
+          "mov %[next_high], %[high]\n\t"
+          "lea 1(%[i]), %[i]\n\t"
+          "jrcxz 2f\n\t"
+          "jmp 1b\n\t"
+          "2:\n\t"
+          "adcx %[zero], %[high]\n\t"
+          "adox %[zero], %[high]"
+          : [high] "+&r"(high), [low] "=&r"(low), [next_high] "=&r"(next_high), [i] "+c"(i)
+          : [a] "r"(a_end), [res] "r"(res_end), "d"(b), [zero] "r"(zero)
+          : "cc", "memory");
+      else
+        __asm__(
+          "xor %k[low], %k[low]\n\t" // clears CF
+          "1:\n\t"
+          "mulx (%[a], %[i], 8), %[low], %[next_high]\n\t"
+          "adcx %[high], %[low]\n\t"
+          "mov %[low], (%[res], %[i], 8)\n\t"
+          "mov %[next_high], %[high]\n\t"
+          "lea 1(%[i]), %[i]\n\t"
+          "jrcxz 2f\n\t"
+          "jmp 1b\n\t"
+          "2:\n\t"
+          "adcx %[zero], %[high]"
+          : [high] "+&r"(high), [low] "=&r"(low), [next_high] "=&r"(next_high), [i] "+c"(i)
+          : [a] "r"(a_end), [res] "r"(res_end), "d"(b), [zero] "r"(zero)
+          : "cc", "memory");
+      return high;
+#else
+      unsigned long long high = 0;
+      unsigned char cf = 0, of = 0;
+      for (size_t i = 0; i < n; i++)
+      {
+        unsigned long long next_high, low = _mulx_u64(load_word(a + 2 * i), b, &next_high), sum;
+        cf = _addcarryx_u64(cf, low, high, &sum);
+        if (accumulate)
+          of = _addcarryx_u64(of, sum, load_word(res + 2 * i), &sum);
+        store_word(res + 2 * i, sum);
+        high = next_high;
+      }
+      // result high word fits, so no overflow here
+      return high + cf + of;
+#endif
+    }
+
+  // schoolbook multiplication with 64-bit words: even-sized prefixes of operands are multiplied by words,
+  // odd top places are added with 32-bit rows, an >= bn >= 2
+  TARGET_BMI2_ADX static void mul_basecase_adx(uint32_t *res, const uint32_t *a, size_t an,
+                                               const uint32_t *b, size_t bn)
+  {
+    size_t ah = an / 2, bh = bn / 2;
+    std::fill(res + 2 * (ah + bh), res + an + bn, 0);
+    store_word(res + 2 * ah, addmul_1_adx<false>(res, a, ah, load_word(b)));
+    for (size_t j = 1; j < bh; j++)
+      store_word(res + 2 * (ah + j), addmul_1_adx<true>(res + 2 * j, a, ah, load_word(b + 2 * j)));
+
+    // a = a_even + a[an - 1] * B^(an - 1), b = b_even + b[bn - 1] * B^(bn - 1)
+    if (an % 2 == 1)
+    {
+      size_t at = an - 1 + 2 * bh;
+      add_1(res + at, res + at, an + bn - at, addmul_1(res + an - 1, b, 2 * bh, a[an - 1]));
+    }
+    if (bn % 2 == 1)
+      res[an + bn - 1] += addmul_1(res + bn - 1, a, an, b[bn - 1]);
+  }
+
+  // schoolbook squaring with 64-bit words, n >= 2
+  TARGET_BMI2_ADX static void sqr_basecase_adx(uint32_t *res, const uint32_t *a, size_t n)
+  {
+    // off-diagonal products of words a_i * a_j, i < j
+    size_t h = n / 2;
+    std::fill(res, res + 2 * n, 0);
+    if (h > 1)
+      store_word(res + 2 * h, addmul_1_adx<false>(res + 2, a + 2, h - 1, load_word(a)));
+    for (size_t i = 1; i + 1 < h; i++)
+      store_word(res + 2 * (i + h), addmul_1_adx<true>(res + 2 * (2 * i + 1), a + 2 * (i + 1), h - i - 1,
+                                                       load_word(a + 2 * i)));
+
+    // double & add diagonal squares of words
+    unsigned long long high_bit = 0;
+    unsigned char carry = 0;
+    for (size_t i = 0; i < h; i++)
+    {
+      unsigned long long word = load_word(a + 2 * i), square_high, square_low = _mulx_u64(word, word, &square_high);
+      unsigned long long low = load_word(res + 4 * i), high = load_word(res + 4 * i + 2);
+      unsigned long long low2 = (low << 1) | high_bit, high2 = (high << 1) | (low >> 63);
+      high_bit = high >> 63;
+      carry = _addcarry_u64(carry, low2, square_low, &low2);
+      carry = _addcarry_u64(carry, high2, square_high, &high2);
+      store_word(res + 4 * i, low2);
+      store_word(res + 4 * i + 2, high2);
+    }
+
+    // a = a_even + t * B^(n - 1): add 2 * t * a_even * B^(n - 1) + t^2 * B^(2n - 2)
+    if (n % 2 == 1)
+    {
+      uint32_t t = a[n - 1];
+      res[2 * n - 2] = addmul_1(res + n - 1, a, n - 1, t);
+      res[2 * n - 1] = addmul_1(res + n - 1, a, n, t);
+    }
+  }
+#endif
+
+  bool wide_basecase()
+  {
+#ifdef PLACE_ARITHMETIC_X86_64
+    static const bool supported = cpu_supports_bmi2_adx();
+    return supported;
+#else
+    return false;
+#endif
+  }
+
+  void mul_basecase(uint32_t *res, const uint32_t *a, size_t an, const uint32_t *b, size_t bn)
+  {
+#ifdef PLACE_ARITHMETIC_X86_64
+    using kernel = void (*)(uint32_t *res, const uint32_t *a, size_t an, const uint32_t *b, size_t bn);
+    static const kernel fast = cpu_supports_bmi2_adx() ? mul_basecase_adx : nullptr;
+    if (fast != nullptr && bn >= 2)
+    {
+      fast(res, a, an, b, bn);
+      return;
+    }
+#endif
+    mul_basecase_portable(res, a, an, b, bn);
+  }
+
+  void sqr_basecase(uint32_t *res, const uint32_t *a, size_t n)
+  {
+#ifdef PLACE_ARITHMETIC_X86_64
+    using kernel = void (*)(uint32_t *res, const uint32_t *a, size_t n);
+    static const kernel fast = cpu_supports_bmi2_adx() ? sqr_basecase_adx : nullptr;
+    if (fast != nullptr && n >= 2)
+    {
+      fast(res, a, n);
+      return;
+    }
+#endif
+    sqr_basecase_portable(res, a, n);
+  }
+
+  void negate_n(uint32_t *places, size_t n)
+  {
+    bool carry = 1;
+    for (size_t i = 0; i < n; i++)
+    {
+      places[i] = ~places[i] + carry;
+      carry = carry && places[i] == 0;
+    }
+  }
+
+  // chunk = value of len <= 8 decimal digits, returns offset of first non-digit (len if none)
+  static size_t decimal_group(uint32_t &chunk, const char *digits, size_t len)
+  {
+    chunk = 0;
+    for (size_t i = 0; i < len; i++)
+    {
+      uint32_t digit = static_cast<uint32_t>(static_cast<unsigned char>(digits[i]) - '0');
+      if (digit > 9)
+        return i;
+      chunk = chunk * 10 + digit;
+    }
+    return len;
+  }
+
+#ifdef PLACE_ARITHMETIC_X86_64
+  // SSE4.1: bit 19 of ECX of leaf 1,
+  // AVX2: bit 5 of EBX of leaf 7 with YMM state enabled by OS (OSXSAVE & XCR0 bits 1, 2)
+  TARGET_XSAVE static int cpu_simd_level()
+  {
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    int max_leaf = info[0];
+    __cpuid(info, 1);
+    uint32_t ecx = static_cast<uint32_t>(info[2]), ebx = 0;
+    if (max_leaf >= 7)
+    {
+      __cpuidex(info, 7, 0);
+      ebx = static_cast<uint32_t>(info[1]);
+    }
+#else
+    unsigned eax, ebx = 0, ecx, edx, unused;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+      return 0;
+    if (!__get_cpuid_count(7, 0, &eax, &ebx, &unused, &edx))
+      ebx = 0;
+#endif
+    bool sse41 = ecx >> 19 & 1, os_ymm = (ecx >> 27 & 1) && (_xgetbv(0) & 6) == 6;
+    if ((ebx >> 5 & 1) && os_ymm)
+      return 2;
+    return sse41 ? 1 : 0;
+  }
+
+  // digits are validated by unsigned comparison with 9 after subtraction of '0',
+  // pairs, quads & octets of digits are combined with multiply-add instructions,
+  // returns number of digits (offset of first non-digit if it is less)
+
+  // chunks[0, 2) = 8-digit groups of digits[0, 16)
+  TARGET_SSE41 static size_t decimal_groups_sse41(uint32_t *chunks, const char *digits)
+  {
+    __m128i d = _mm_sub_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(digits)), _mm_set1_epi8('0'));
+    unsigned valid = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_min_epu8(d, _mm_set1_epi8(9)), d)));
+    if (valid != 0xFFFF)
+    {
+      size_t i = 0;
+      while (valid >> i & 1)
+        i++;
+      return i;
+    }
+    __m128i pairs = _mm_maddubs_epi16(d, _mm_setr_epi8(10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1));
+    __m128i quads = _mm_madd_epi16(pairs, _mm_setr_epi16(100, 1, 100, 1, 100, 1, 100, 1));
+    quads = _mm_packus_epi32(quads, quads);
+    __m128i octets = _mm_madd_epi16(quads, _mm_setr_epi16(10000, 1, 10000, 1, 10000, 1, 10000, 1));
+    chunks[0] = static_cast<uint32_t>(_mm_cvtsi128_si32(octets));
+    chunks[1] = static_cast<uint32_t>(_mm_extract_epi32(octets, 1));
+    return 16;
+  }
+
+  // chunks[0, 4) = 8-digit groups of digits[0, 32)
+  TARGET_AVX2 static size_t decimal_groups_avx2(uint32_t *chunks, const char *digits)
+  {
+    __m256i d = _mm256_sub_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(digits)),
+                                _mm256_set1_epi8('0'));
+    uint32_t valid = static_cast<uint32_t>(
+      _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_min_epu8(d, _mm256_set1_epi8(9)), d)));
+    if (valid != 0xFFFFFFFF)
+    {
+      size_t i = 0;
+      while (valid >> i & 1)
+        i++;
+      return i;
+    }
+    __m256i pairs = _mm256_maddubs_epi16(d, _mm256_setr_epi8(10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1,
+                                                             10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1));
+    __m256i quads = _mm256_madd_epi16(pairs, _mm256_setr_epi16(100, 1, 100, 1, 100, 1, 100, 1,
+                                                               100, 1, 100, 1, 100, 1, 100, 1));
+    // packing is done in 128-bit lanes: octets are [c0, c1, c0, c1 | c2, c3, c2, c3]
+    quads = _mm256_packus_epi32(quads, quads);
+    __m256i octets = _mm256_madd_epi16(quads, _mm256_setr_epi16(10000, 1, 10000, 1, 10000, 1, 10000, 1,
+                                                                10000, 1, 10000, 1, 10000, 1, 10000, 1));
+    chunks[0] = static_cast<uint32_t>(_mm256_extract_epi32(octets, 0));
+    chunks[1] = static_cast<uint32_t>(_mm256_extract_epi32(octets, 1));
+    chunks[2] = static_cast<uint32_t>(_mm256_extract_epi32(octets, 4));
+    chunks[3] = static_cast<uint32_t>(_mm256_extract_epi32(octets, 5));
+    return 32;
+  }
+#endif
+
+  size_t decimal_chunks(uint32_t *chunks, const char *digits, size_t n)
+  {
+    if (n == 0)
+      return 0;
+    size_t count = (n + 7) / 8, first = n - (count - 1) * 8;
+    size_t valid = decimal_group(chunks[0], digits, first);
+    if (valid != first)
+      return valid;
+
+    size_t i = 1, at = first;
+#ifdef PLACE_ARITHMETIC_X86_64
+    static const int simd_level = cpu_simd_level();
+    if (simd_level >= 2)
+      for (; i + 4 <= count; i += 4, at += 32)
+        if ((valid = decimal_groups_avx2(chunks + i, digits + at)) != 32)
+          return at + valid;
+    if (simd_level >= 1)
+      for (; i + 2 <= count; i += 2, at += 16)
+        if ((valid = decimal_groups_sse41(chunks + i, digits + at)) != 16)
+          return at + valid;
+#endif
+    for (; i < count; i++, at += 8)
+      if ((valid = decimal_group(chunks[i], digits + at, 8)) != 8)
+        return at + valid;
+    return n;
+  }
+
+  size_t normalized_size(const uint32_t *places, size_t n)
+  {
+    while (n > 0 && places[n - 1] == 0)
+      n--;
+    return n;
+  }
+
+  int compare_n(const uint32_t *a, const uint32_t *b, size_t n)
+  {
+    for (size_t i = n; i > 0; i--)
+      if (a[i - 1] != b[i - 1])
+        return a[i - 1] > b[i - 1] ? 1 : -1;
+    return 0;
+  }
+
+  int compare_places(const uint32_t *a, size_t an, const uint32_t *b, size_t bn)
+  {
+    if (an != bn)
+      return an > bn ? 1 : -1;
+    return compare_n(a, b, an);
+  }
+} // end of 'big_int_util' namespace
@@ -0,0 +1,63 @@
+/* Nikolai Kholiavin, M3138 */
+
+#ifndef PLACE_ARITHMETIC_H
+#define PLACE_ARITHMETIC_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace big_int_util
+{
+  /* Low-level arithmetic on little-endian place arrays (e.g. optimized_buffer data),
+   * nothing is allocated, result may be written in place of the first operand */
+
+  // res[0, n) = a[0, n) + b[0, n), returns carry
+  uint32_t add_n(uint32_t *res, const uint32_t *a, const uint32_t *b, size_t n);
+  // res[0, n) = a[0, n) - b[0, n), returns borrow
+  uint32_t sub_n(uint32_t *res, const uint32_t *a, const uint32_t *b, size_t n);
+  // res[0, an) = a[0, an) + b[0, bn), an >= bn, returns carry
+  uint32_t add(uint32_t *res, const uint32_t *a, size_t an, const uint32_t *b, size_t bn);
+  // res[0, n) = a[0, n) + b, returns carry (stops early when done in place)
+  uint32_t add_1(uint32_t *res, const uint32_t *a, size_t n, uint32_t b);
+  // res[0, an) = a[0, an) - b[0, bn), an >= bn, returns borrow
+  uint32_t sub(uint32_t *res, const uint32_t *a, size_t an, const uint32_t *b, size_t bn);
+
+  // res[0, n) = a[0, n) * b, returns high place
+  uint32_t mul_1(uint32_t *res, const uint32_t *a, size_t n, uint32_t b);
+  // res[0, n) += a[0, n) * b, returns high place
+  uint32_t addmul_1(uint32_t *res, const uint32_t *a, size_t n, uint32_t b);
+  // res[0, n) -= a[0, n) * b, returns high place of subtrahend & borrow
+  uint32_t submul_1(uint32_t *res, const uint32_t *a, size_t n, uint32_t b);
+
+  // res[0, n) = a[0, n) << bits, 0 < bits < 32, returns shifted out high bits (may be done in place)
+  uint32_t lshift(uint32_t *res, const uint32_t *a, size_t n, unsigned bits);
+  // res[0, n) = a[0, n) >> bits, 0 < bits < 32, returns shifted out low bits in high ones of result
+  // (may be done in place)
+  uint32_t rshift(uint32_t *res, const uint32_t *a, size_t n, unsigned bits);
+
+  // whether basecase multiplication & squaring use 64-bit words (x86-64 with BMI2 & ADX)
+  bool wide_basecase();
+  // schoolbook multiplication res[0, an + bn) = a[0, an) * b[0, bn), an >= bn >= 1,
+  // res must not overlap operands (BMI2 & ADX kernel is used if CPU supports them)
+  void mul_basecase(uint32_t *res, const uint32_t *a, size_t an, const uint32_t *b, size_t bn);
+  // schoolbook squaring res[0, 2n) = a[0, n)^2, n >= 1, each off-diagonal product is computed once
+  // and doubled, res must not overlap operand (BMI2 & ADX kernel is used if CPU supports them)
+  void sqr_basecase(uint32_t *res, const uint32_t *a, size_t n);
+
+  // chunks[0, (n + 7) / 8) = values of 8-digit groups of decimal digits[0, n) from high ones
+  // (the first group may be shorter), returns offset of first non-digit or n
+  // (SSE4.1 or AVX2 kernel is used if CPU supports them)
+  size_t decimal_chunks(uint32_t *chunks, const char *digits, size_t n);
+
+  // 2's complement negation in place
+  void negate_n(uint32_t *places, size_t n);
+
+  // size without high zero places
+  size_t normalized_size(const uint32_t *places, size_t n);
+  // compares a[0, n) and b[0, n)
+  int compare_n(const uint32_t *a, const uint32_t *b, size_t n);
+  // compares normalized place arrays
+  int compare_places(const uint32_t *a, size_t an, const uint32_t *b, size_t bn);
+}
+
+#endif // PLACE_ARITHMETIC_H
@@ -0,0 +1,181 @@
+/* Nikolai Kholiavin, M3138 */
+#include "thread_pool.h"
+
+namespace big_int_util
+{
+  static thread_local const thread_pool *current_pool = nullptr;
+  static thread_local size_t current_worker = 0;
+
+  thread_pool::thread_pool(size_t workers)
+  {
+    for (size_t i = 0; i < workers; i++)
+      queues.push_back(std::make_unique<task_queue>());
+    try
+    {
+      for (size_t i = 0; i < workers; i++)
+        threads.emplace_back([this, i] { work(i); });
+    }
+    catch (...)
+    {
+      shutdown();
+      throw;
+    }
+  }
+
+  thread_pool::~thread_pool()
+  {
+    shutdown();
+  }
+
+  void thread_pool::shutdown()
+  {
+    {
+      std::lock_guard<std::mutex> lock(sleep_m);
+      stop = true;
+      sleep_cv.notify_all();
+    }
+    for (std::thread &thread : threads)
+      if (thread.joinable())
+        thread.join();
+  }
+
+  size_t thread_pool::current_index() const
+  {
+    return current_pool == this ? current_worker : size();
+  }
+
+  void thread_pool::submit(task t)
+  {
+    size_t index = current_index();
+    if (index == size())
+      index = next_queue++ % size();
+    {
+      std::lock_guard<std::mutex> lock(queues[index]->m);
+      queues[index]->tasks.push_back(std::move(t));
+    }
+    queued++;
+    std::lock_guard<std::mutex> lock(sleep_m);
+    sleep_cv.notify_one();
+  }
+
+  bool thread_pool::pop(size_t index, bool back, task &t)
+  {
+    std::lock_guard<std::mutex> lock(queues[index]->m);
+    std::deque<task> &tasks = queues[index]->tasks;
+    if (tasks.empty())
+      return false;
+    if (back)
+    {
+      t = std::move(tasks.back());
+      tasks.pop_back();
+    }
+    else
+    {
+      t = std::move(tasks.front());
+      tasks.pop_front();
+    }
+    queued--;
+    return true;
+  }
+
+  bool thread_pool::try_run_one()
+  {
+    if (queued == 0)
+      return false;
+
+    size_t self = current_index(), n = size();
+    task t;
+    bool found = self < n && pop(self, true, t);
+    // steal from others starting with the next queue
+    for (size_t i = 1; !found && i <= n; i++)
+      found = pop((self + i) % n, false, t);
+    if (!found)
+      return false;
+    t();
+    return true;
+  }
+
+  void thread_pool::work(size_t index)
+  {
+    current_pool = this;
+    current_worker = index;
+    while (true)
+    {
+      if (try_run_one())
+        continue;
+      std::unique_lock<std::mutex> lock(sleep_m);
+      sleep_cv.wait(lock, [this] { return stop || queued != 0; });
+      if (stop)
+        return;
+    }
+  }
+
+  task_group::~task_group()
+  {
+    wait_all();
+  }
+
+  void task_group::run(thread_pool::task t)
+  {
+    {
+      std::lock_guard<std::mutex> lock(m);
+      pending++;
+    }
+    try
+    {
+      pool.submit([this, t = std::move(t)]
+        {
+          try
+          {
+            t();
+          }
+          catch (...)
+          {
+            std::lock_guard<std::mutex> lock(m);
+            if (!error)
+              error = std::current_exception();
+          }
+          // notify under lock: waiter may destroy the group right after
+          std::lock_guard<std::mutex> lock(m);
+          if (--pending == 0)
+            done_cv.notify_all();
+        });
+    }
+    catch (...)
+    {
+      std::lock_guard<std::mutex> lock(m);
+      pending--;
+      throw;
+    }
+  }
+
+  void task_group::wait_all()
+  {
+    while (true)
+    {
+      {
+        std::lock_guard<std::mutex> lock(m);
+        if (pending == 0)
+          return;
+      }
+      // help with queued tasks, sleep if all of them are taken
+      if (!pool.try_run_one())
+      {
+        std::unique_lock<std::mutex> lock(m);
+        done_cv.wait(lock, [this] { return pending == 0; });
+        return;
+      }
+    }
+  }
+
+  void task_group::wait()
+  {
+    wait_all();
+    if (error)
+    {
+      std::exception_ptr e = error;
+      error = nullptr;
+      std::rethrow_exception(e);
+    }
+  }
+} // end of 'big_int_util' namespace
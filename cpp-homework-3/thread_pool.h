@@ -0,0 +1,87 @@
+/* Nikolai Kholiavin, M3138 */
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace big_int_util
+{
+  /* Work-stealing thread pool: each worker takes tasks from the back of its own queue
+   * and steals from the front of the others' queues when it is empty */
+  class thread_pool
+  {
+  public:
+    using task = std::function<void ()>;
+
+    explicit thread_pool(size_t workers);
+    thread_pool(const thread_pool &other) = delete;
+    thread_pool & operator=(const thread_pool &other) = delete;
+    ~thread_pool();
+
+    size_t size() const
+    {
+      return threads.size();
+    }
+
+    // pushes task to current worker's queue (or to some queue for foreign threads)
+    void submit(task t);
+    // runs one queued task in current thread, returns false if there are none
+    bool try_run_one();
+
+  private:
+    struct task_queue
+    {
+      std::mutex m;
+      std::deque<task> tasks;
+    };
+
+    std::vector<std::unique_ptr<task_queue>> queues;
+    std::vector<std::thread> threads;
+    std::atomic<size_t> queued{0}, next_queue{0};
+    std::mutex sleep_m;
+    std::condition_variable sleep_cv;
+    bool stop = false;
+
+    // index of current thread's queue in this pool or size() for foreign threads
+    size_t current_index() const;
+    bool pop(size_t index, bool back, task &t);
+    void work(size_t index);
+    // stops & joins workers
+    void shutdown();
+  };
+
+  /* Group of tasks with waiting for all of them,
+   * waiting thread runs queued tasks meanwhile, first exception is rethrown by wait */
+  class task_group
+  {
+  public:
+    explicit task_group(thread_pool &pool) : pool(pool) {}
+    task_group(const task_group &other) = delete;
+    task_group & operator=(const task_group &other) = delete;
+    // waits for tasks which may reference caller's data, ignoring their exceptions
+    ~task_group();
+
+    void run(thread_pool::task t);
+    void wait();
+
+  private:
+    thread_pool &pool;
+    size_t pending = 0;
+    std::mutex m;
+    std::condition_variable done_cv;
+    std::exception_ptr error;
+
+    void wait_all();
+  };
+}
+
+#endif // THREAD_POOL_H